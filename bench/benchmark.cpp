@@ -0,0 +1,203 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <iomanip>
+#include <functional>
+#include "Memory.hpp"
+#include "Vecteur.hpp"
+#include "VariableEnv.hpp"
+#include "Population.hpp"
+#include "Environment.hpp"
+#include "Functor.hpp"
+#include "Random.hpp"
+#ifndef HEADLESS
+#include "Display.hpp"
+#endif
+
+//===========================================================================
+//                          Description
+//===========================================================================
+//
+// Microbenchmarks of the lattice kernels.
+//
+// Every case is built from fixed seeds, so two runs (or two versions of the code)
+// time exactly the same work. For each case we report the throughput in cells per
+// second, and the number of heap allocations and allocated bytes per cell (counted
+// by the operator new of Memory.hpp, the benchmark is always built with MEMORY_TRACKING).
+//
+// Usage : benchmark [--full] [--filter name] [--json file]
+//   --full    grids from 100x100 to 4000x4000 (a lot of memory), default up to 400x400
+//   --filter  only the cases whose name contains the string
+//   --json    write the results to a JSON file (to diff across versions)
+//
+//===========================================================================
+//                          Benchmark cases
+//===========================================================================
+
+struct BenchResult
+{
+    string name;
+    int m, n, nSpecies, speed;
+    int repetitions;
+    double seconds;             //Best time of one repetition
+    double cellsPerSecond;
+    double allocationsPerCell;
+    double bytesPerCell;
+};
+
+//Time a kernel : repeated until 0.2s (at least 3 times), keep the best time
+BenchResult timeCase(string name, int m, int n, int nSpecies, int speed, const function<void()>& kernel)
+{
+    BenchResult r{name, m, n, nSpecies, speed, 0, 1e30, 0, 0, 0};
+    double total = 0;
+    while ((r.repetitions < 3) or (total < 0.2)){
+        MemoryRecord memoryStart = memoryCheckpoint();
+        auto start = chrono::steady_clock::now();
+        kernel();
+        double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        MemoryRecord used = memorySince(memoryStart);
+        r.allocationsPerCell = double(used.allocations) / (m*n);
+        r.bytesPerCell = double(used.bytes) / (m*n);
+        r.seconds = min(r.seconds, t);
+        total += t;
+        r.repetitions++;
+    }
+    r.cellsPerSecond = m*n / r.seconds;
+    return r;
+}
+
+//Species with random niches in a 3 dimensional environment
+vector<Population> makeSpecies(int nSpecies, int speed)
+{
+    CounterRNG rng(2024);
+    vector<Population> sp;
+    for (int k=0; k<nSpecies; k++){
+        VariableEnv<Conditions> niche(Conditions({rng.uniform(0, 0, k, 0), rng.uniform(0, 0, k, 1), rng.uniform(0, 0, k, 2)}));
+        Tolerance tol({Conditions({0.5, 0, 0}), Conditions({0, 0.5, 0}), Conditions({0, 0, 0.5})});
+        sp.push_back(Population(niche, "S"+to_string(k), speed, tol));
+    }
+    return sp;
+}
+
+//Environment of normal conditions, every node occupied by a random species
+Environment makeEnvironment(int m, int n, int nSpecies, int speed, string envType)
+{
+    map<string, float> parameters;
+    parameters["m"] = m;
+    parameters["n"] = n;
+    parameters["distMean"] = 0.5;
+    parameters["distVar"] = 0.5;
+    parameters["seed"] = 7;
+
+    Environment E(makeSpecies(nSpecies, speed), parameters, "bench", "normal", "none", envType);
+    CounterRNG rng(11);
+    for (int c=0; c<m*n; c++){
+        E.repartition[c] = vector<int>({E.species[rng.uniformInt(0, nSpecies-1, 0, 0, c)].id});
+    }
+    return E;
+}
+
+//===========================================================================
+//                               Main
+//===========================================================================
+
+int main(int argc, char *argv[])
+{
+    bool full = false;
+    string filter = "";
+    string jsonFile = "";
+    for (int k=1; k<argc; k++){
+        string arg = argv[k];
+        if (arg=="--full"){full = true;}
+        else if ((arg=="--filter") and (k+1<argc)){filter = argv[++k];}
+        else if ((arg=="--json") and (k+1<argc)){jsonFile = argv[++k];}
+    }
+
+    vector<int> sizes = full ? vector<int>({100, 500, 1000, 2000, 4000}) : vector<int>({100, 200, 400});
+    vector<int> speciesCounts({2, 3, 8});
+    vector<int> speeds({1, 3, 8});
+    vector<BenchResult> results;
+
+    auto selected = [&](string name){return (filter=="") or (name.find(filter) != string::npos);};
+    auto record = [&](BenchResult r){
+        results.push_back(r);
+        cout << left << setw(24) << r.name << right << setw(6) << r.m << "x" << left << setw(6) << r.n << right
+             << " sp=" << setw(2) << r.nSpecies << " d=" << setw(2) << r.speed
+             << scientific << setprecision(3) << setw(12) << r.cellsPerSecond << " cells/s"
+             << fixed << setprecision(2) << setw(10) << r.allocationsPerCell << " allocs/cell"
+             << setw(10) << r.bytesPerCell << " B/cell" << endl;
+    };
+
+    for (int size : sizes){
+        for (int nSpecies : speciesCounts){
+
+            //Kernels that do not depend on the diffusion speed
+            Environment E = makeEnvironment(size, size, nSpecies, 1, "constant");
+            Environment migrated = E.migration();
+            Environment migratedVariable(migrated);
+            migratedVariable.envType = "variable";
+
+            if (selected("selection_constant")){
+                record(timeCase("selection_constant", size, size, nSpecies, 1, [&](){Environment out = migrated.selection();}));
+            }
+            if (selected("selection_variable")){
+                record(timeCase("selection_variable", size, size, nSpecies, 1, [&](){Environment out = migratedVariable.selection();}));
+            }
+            if (selected("gaussianScore")){
+                record(timeCase("gaussianScore", size, size, nSpecies, 1, [&](){
+                    gaussianScore f; float sum = 0;
+                    for (int c=0; c<size*size; c++){sum += f(E.conditions[c].parameters, E.species[c % nSpecies]);}
+                    if (sum < 0){cout << sum;}
+                }));
+            }
+            if (selected("adaptationScoreFunctor")){
+                record(timeCase("adaptationScoreFunctor", size, size, nSpecies, 1, [&](){
+                    adaptationScoreFunctor f;
+                    for (int k=0; k<nSpecies; k++){Vecteur<float> grid = f(E.conditions, E.species[k], size, size);}
+                }));
+            }
+            if (selected("countPopulations")){
+                record(timeCase("countPopulations", size, size, nSpecies, 1, [&](){Vecteur<float> counts = E.countPopulations();}));
+            }
+#ifndef HEADLESS
+            if (selected("repartitionToPixel")){
+                record(timeCase("repartitionToPixel", size, size, nSpecies, 1, [&](){delete[] get<0>(repartitionToPixel(E));}));
+            }
+            if (selected("changeToPixel")){
+                vector<int> changes = migrated.selection().numberOfChanges;
+                record(timeCase("changeToPixel", size, size, nSpecies, 1, [&](){delete[] get<0>(changeToPixel(changes));}));
+            }
+            if (selected("envToPixel")){
+                record(timeCase("envToPixel", size, size, nSpecies, 1, [&](){delete[] get<0>(envToPixel(E.conditions, 0));}));
+            }
+#endif
+
+            //Migration for each diffusion speed
+            for (int speed : speeds){
+                if (!selected("migration")){continue;}
+                Environment Es = makeEnvironment(size, size, nSpecies, speed, "constant");
+                Es.migrationMethod = "stencil";
+                record(timeCase("migration_stencil", size, size, nSpecies, speed, [&](){Environment out = Es.migration();}));
+                Es.migrationMethod = "distance";
+                record(timeCase("migration_distance", size, size, nSpecies, speed, [&](){Environment out = Es.migration();}));
+            }
+        }
+    }
+
+    //JSON output
+    if (jsonFile != ""){
+        ofstream file(jsonFile);
+        file << "[" << endl;
+        for (int k=0; k<int(results.size()); k++){
+            const BenchResult& r = results[k];
+            file << "  {\"name\": \"" << r.name << "\", \"m\": " << r.m << ", \"n\": " << r.n
+                 << ", \"species\": " << r.nSpecies << ", \"speed\": " << r.speed
+                 << ", \"repetitions\": " << r.repetitions << ", \"seconds\": " << r.seconds
+                 << ", \"cellsPerSecond\": " << r.cellsPerSecond
+                 << ", \"allocationsPerCell\": " << r.allocationsPerCell
+                 << ", \"bytesPerCell\": " << r.bytesPerCell << "}" << (k+1 < int(results.size()) ? "," : "") << endl;
+        }
+        file << "]" << endl;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef DEF_DOMAINDECOMPOSITION_HPP
+#define DEF_DOMAINDECOMPOSITION_HPP
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <sys/types.h>
+#include "Environment.hpp"
+#include "TemporalBlocking.hpp"
+#include "Vecteur.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Run of a Simulation as several cooperating processes (Environment::processes).
+//
+// The lattice is cut in bands of rows, one per process. The process running the
+// Simulation (rank 0) forks the others, which share with it the occupants, the
+// numbers of changes and the colonisation times through an anonymous shared mapping
+// (Linux). At every iteration each process migrates and selects its own rows with
+// the tiles of TemporalBlocking, reading the halo rows (largest stencil radius) owned
+// by its neighbours from the shared lattice, then waits for the others at a barrier.
+//
+// The numbers of changes and of nodes gained by each species of every process are written
+// in shared slots (two sets, used in turn by the iterations) and summed by every
+// process after the barrier : all the processes take the same stationarity decision
+// and stop at the same iteration. The result is exactly the one of a single process.
+//
+// A process that dies would leave the others waiting at the barrier : while it waits,
+// rank 0 checks that the processes it forked are running (waitpid) and stops the run
+// (the other processes are killed) if one has ended, the others end if rank 0 has.
+//
+//======================================================================
+//                   Class DomainDecomposition definition
+//======================================================================
+
+//Barrier of the processes in the shared mapping : number of processes arrived, number of barriers passed
+struct ProcessBarrier
+{
+    atomic<int> arrived;
+    atomic<int> generation;
+};
+
+class DomainDecomposition
+{
+public:
+    int processes = 1;                          //Number of processes
+    int rank = 0;                               //Rank of this process (0 : the process running the Simulation)
+    vector<int> firstRow;                       //First row of each process (and the number of rows at the end)
+    Vecteur<float> counts;                      //Number of nodes of each species after the last iteration (every process)
+
+    //Constructors
+    DomainDecomposition(){};
+    DomainDecomposition(const DomainDecomposition&) = delete;
+    DomainDecomposition& operator=(const DomainDecomposition&) = delete;
+
+    //Member functions
+    void start(const Environment& env, int nProcesses, int nIter, const vector<int>& colonisationTime);  //Share the lattice and fork the other processes
+    int advance(Environment& env, int iteration);                   //One iteration of every process (rank 0), returns the number of changes
+    void writeBack(Environment& env) const;                         //Repartition of the environment from the shared occupants
+    void finish(Environment& env, vector<int>& colonisationTime);   //Wait for the other processes and collect the results
+
+private:
+    TemporalBlocking engine;                    //Scores and stencils of the rule (tiles of one iteration)
+    int mn = 0;                                 //Number of nodes
+    int S = 0;                                  //Number of species
+    int current = 0;                            //Shared buffer of the current occupants (0 or 1)
+    vector<int> changedAt;                      //Nodes of this process changed at the last iteration
+    vector<pid_t> children;                     //Processes forked by rank 0
+    pid_t parent = 0;                           //Process of rank 0
+
+    //Shared mapping
+    void* shared = nullptr;
+    size_t sharedBytes = 0;
+    ProcessBarrier* barrier = nullptr;
+    int* occupant[2];                           //Occupants (index of the species, -1 if empty)
+    int* numberOfChanges[2];                    //Numbers of changes of the nodes
+    int* colonisation;                          //Colonisation times
+    int* stepChanges;                           //Changes of each process (two sets of processes slots)
+    int* stepDeltas;                            //Nodes gained by each species in each process (two sets of processes*S slots)
+
+    int step(const Environment& env, int iteration);                //One iteration of this process and the reductions
+    void wait();                                                    //Barrier of the processes (stops the run if a process died)
+    void checkProcesses();                                          //Stop the run if a process died
+};
+
+#endif
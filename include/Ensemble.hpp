@@ -0,0 +1,58 @@
+#ifndef DEF_ENSEMBLE_HPP
+#define DEF_ENSEMBLE_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Environment.hpp"
+#include "Vecteur.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Bit-sliced ensemble of replicates of the same rule (percolation studies).
+//
+// The replicates are environments of the same size and species, generated with
+// different random streams (parameters["replicate"]). The occupancy of a species is
+// one 64 bits word per node : the bit r is set if the replicate r holds the species.
+// An iteration pushes the words of every source along the stencils and selects the
+// winners with bitwise logic, so one pass over the lattice advances 64 replicates
+// (larger ensembles run in batches of 64).
+//
+// The run is the one of a Simulation, for a determinist migration and selection in
+// a constant environment : the scores are compared once (bit r of better(k,l) set if
+// k scores more than l on the node in the replicate r) and the order of the arrivals
+// is kept (bit r of before(k,l) set if k is a candidate before l), so ties are broken
+// as in Environment::chooseCandidate. The numbers of changes are not kept.
+//
+//======================================================================
+//                       Class Ensemble definition
+//======================================================================
+
+class Ensemble
+{
+public:
+    int m;                                          //Number of rows of the lattice
+    int n;                                          //Number of columns of the lattice
+    int replicates;                                 //Number of replicates
+    Vecteur<int> timeBeforeStationarity;            //Number of iterations before stationarity of each replicate (as Simulation)
+    Vecteur<Vecteur<float>> counts;                 //Final number of nodes of each species in each replicate
+
+    //Constructor (runs the simulation of every replicate)
+    Ensemble(const vector<Environment>& envs, int nIter);
+
+    //Member functions
+    void writeBack(Environment& env, int replicate) const;     //Final repartition of a replicate
+
+private:
+    int S;                                          //Number of species
+    vector<Population> species;                     //Species list (same in every replicate)
+    vector<uint64_t> occupant;                      //Occupancy words of every batch, species and node (index (batch*S+k)*m*n+c)
+
+    void run(const vector<Environment>& envs, int batch, int nIter);
+};
+
+#endif
@@ -10,11 +10,12 @@
 #include <string>
 #include "VariableEnv.hpp"
 #include "Population.hpp"
-#include "Functor.hpp"
-#include <SFML/Graphics.hpp>
-#include <filesystem>
-#include "Display.hpp"
-
+#include "Vecteur.hpp"
+#include "Random.hpp"
+#include "Stencil.hpp"
+#include "Raster.hpp"
+#include "Shared.hpp"
+#include "ScoreLayer.hpp"
 
 using namespace std;
 
@@ -27,12 +28,36 @@ using namespace std;
 // Notably, generation and general parameters, initial repartions,
 //
 // Define related functions and operators. 
-// Notably, for display.
+//
+// After a migration the candidates of a node are the species that reached it, each
+// species once in the order of its first arrival (the occupant first) : the arrivals
+// are deduplicated with a bitmask of the species list per node, so a node holds at most
+// one candidate per species whatever the number of neighbours.
+//
+// Species can appear during a run : when an invader displaces the first candidate of a
+// node (two species meeting), the node gets their hybrid with probability
+// hybridProbability. A hybrid is appended to the species list at its first appearance
+// (its score layer is computed then, the layers of the other species are kept) and is
+// reused for the same pair afterwards, up to maxSpecies species. The species list and
+// the table of the hybrids are shared by the copies of the environment, so hundreds of
+// species cost nothing per iteration.
+//
+// An environment built from images keeps the pixel values of its nodes, a percolation
+// environment the draw of its nodes (levels) : the score layer of a species is then a
+// table of the levels (see ScoreLayer.hpp). With compactStorage the score layers of the
+// other environments are stored as ranks on 8 or 16 bits (exact scores, see
+// ScoreLayer.hpp) and the conditions of an environment with levels are not stored :
+// they are the ones of the levels of the nodes (conditionsAt, conditionLayer).
+//
+// The definitions are in src/core/Environment.cpp, part of the simulation core
+// library (no graphics dependency). The display of an environment is in the
+// rendering add-on (Display.hpp).
 //
 //======================================================================
 //Class Environment definition
 //======================================================================
 
+
 class Environment
 {
     public :
@@ -46,26 +71,70 @@ class Environment
         float percolationProbability;                             //Percolation Probability used to generate the environnement (if used)
         string name;                                              //Name of the environnment with its characteristics
         string envType;
-
-        vector<VariableEnv<Vecteur<float>>> conditions;           //Environmental matrix
-        vector<Population> species;                                   //List of species that live in the Environment
-        vector<vector<Population>> repartition;                       //Species repartition matrix
+        string migrationType = "determinist";                     //Type of migration : "determinist", "stochastic"
+        string selectionType = "determinist";                     //Type of selection : "determinist", "proportional", "softmax"
+        float dispersalProbability = 1;                           //Probability to colonise each neighbour (stochastic migration)
+        float softmaxTemperature = 1;                             //Temperature of the softmax competition (softmax selection)
+        float hybridProbability = 0;                              //Probability that two species meeting in a node give their hybrid
+        int maxSpecies = 256;                                     //Largest number of species (no new hybrid once the list is full)
+        int step = 0;                                             //Number of iterations done (used to key the random draws)
+        string migrationMethod = "auto";                          //Reach computation : "stencil", "distance" (linear-time minimum filter), "auto"
+        int distanceThreshold = 4;                                //Smallest diffusion speed using the minimum filter in "auto"
+        string neighbourhood = "vonNeumann";                      //Neighbourhood of the migration : "vonNeumann", "moore", "custom"
+        Vecteur<Vecteur<int>> neighbourhoodKernel;                //Kernel of the "custom" neighbourhood (0/1 matrix centered on the node)
+        map<int, Stencil> stencils;                               //Migration stencil of each distinct diffusion speed
+        int halo = 0;                                             //Width of the halo padding the lattice (largest stencil radius)
+        string rowBoundary = "open";                              //Boundary condition of the rows (top/bottom) : "open", "periodic", "reflective"
+        string columnBoundary = "open";                           //Boundary condition of the columns (left/right) : "open", "periodic", "reflective"
+        string solver = "auto";                                   //Engine of a Simulation : "auto", "iterative", "tiled" (see Simulation.hpp)
+        int tileSize = 64;                                        //Side of the tiles of the "tiled" solver
+        int blockSteps = 4;                                       //Iterations advanced per tile by the "tiled" solver
+        int tiledThreshold = 1<<20;                               //Smallest number of nodes using the "tiled" solver in "auto"
+        int processes = 1;                                        //Number of cooperating processes of a Simulation (domain decomposition)
+        bool compactStorage = false;                              //Score layers stored as ranks, conditions of the images and percolations stored as levels
+        bool recordInterface = false;                             //Record the interface length at every iteration of a Simulation (scan of the lattice)
+        CounterRNG rng;                                           //Counter-based random generator keyed on (seed, replicate)
+
+        Shared<vector<VariableEnv<Conditions>>> conditions;       //Environmental matrix (read-only layer shared by the copies, see Shared.hpp)
+        Shared<vector<Population>> species;                       //List of species that live in the Environment (shared by the copies, hybrids appended)
+        Shared<map<pair<int,int>, int>> hybrids;                  //Id of the hybrid of each pair of species ids (first candidate, invader) already met
+        vector<int> speciesTable;                                 //Index in the species list of each id (-1 if absent), see indexSpecies
+        vector<vector<int>> repartition;                          //Species repartition matrix (ids of the Populations of each node, see Population.hpp)
         vector<int> numberOfChanges;                              //Number of changes in the occupancy for every spot in the lattice
-        map<string, Vecteur<float>> adaptationScores;             //Species adaptation scores
+        map<string, ScoreLayer> adaptationScores;                 //Species adaptation scores (read-only layers shared by the copies)
+        Shared<vector<uint16_t>> levels;                          //Level of every node (pixel value, pair of pixel values, or percolation draw)
+        int levelCount = 0;                                       //Number of levels (256 : one image, 65536 : two images, 2 : percolation, 0 : no levels)
         
         //Constructors
         Environment(){};                                                                                                    //Empty constructor
-        Environment(vector<Population> sp, map<string,float> parameters, string filename, string GenType, string repType, string variability);      //Constructor of an environment matrix using functors for initial species repartition and environmental conditions 
-        Environment(const sf::Image& image, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability); //Constructor of an environment matrix using image for environmental conditions
-        Environment(const sf::Image& image1, const sf::Image& image2, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability);
+        Environment(vector<Population> sp, map<string,float> parameters, string filename, string GenType, string repType, string variability="variable");      //Constructor of an environment matrix using functors for initial species repartition and environmental conditions 
+        Environment(const Raster& image, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability="variable"); //Constructor of an environment matrix using image for environmental conditions
+        Environment(const Raster& image1, const Raster& image2, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability="variable");
+        Environment(const Environment& site, vector<Population> sp, map<string,float> parameters, string filename, string repType);            //Constructor sharing the conditions and scores of a site
 
         //Member functions
+        void readParameters(map<string,float> parameters, string variability);
+        Conditions conditionsAt(int c) const;
+        Shared<vector<VariableEnv<Conditions>>> conditionLayer() const;
         Environment migration();
         Environment selection();
         Environment environmentalChange(float t);
         Vecteur<float> countPopulations();
-        void display(string type, int envDimension);
-        void display(string type, int envDimension, int i);
+        int speciesIndex(int id) const;
+        const Population& population(int id) const;
+        void indexSpecies();
+        int addSpecies(const Population& sp);
+        ScoreLayer scoreLayer(const Population& sp) const;
+        int hybrid(int first, int invader);
+        int interfaceLength() const;
+        void setNeighbourhood(string shape, const Vecteur<Vecteur<int>>& kernel = Vecteur<Vecteur<int>>());
+        const Stencil& stencil(int speed);
+        bool usesDistance(int speed) const;
+        template<class Candidates> int chooseCandidate(const Candidates& candidates, const Vecteur<float>& scores, int cell, int iteration) const;
+        bool usesEventDriven() const;
+        bool usesTemporalBlocking() const;
+        bool usesDomainDecomposition() const;
+        bool supportsTiles() const;
 
         //Operators
         bool operator ==(const Environment& env){return(this->repartition==env.repartition);};
@@ -76,445 +145,7 @@ class Environment
 //External functions/operators
 //======================================================================
 
-//Print an envrionment in the terminal(repartition and conditions)
-ostream& operator <<(ostream & out, const Environment& E)
-{   
-    for(int i=0; i<E.n; i++)
-        {
-            out << "[";
-            for (int j=0; j<E.n; j++)
-            {
-                if (E.repartition[i*E.n+j].size()!=0) {out << E.repartition[i*E.n+j][0].name << " ";}
-                else {out << "  ";}
-            }
-            out << "]";
-            for (int j=0; j<E.n; j++)
-            {
-                out << E.conditions[i*E.n+j].parameters << " ";
-            }
-            out << endl;
-        }
-    return out;
-}
-
-//make a customed name for the environment with its parameters
-string makeName(string filename, map<string,float> parameters, vector<Population> sp){
-    
-    //Add the parameters to the filename
-    for (auto it=parameters.begin(); it!=parameters.end(); ++it){
-        std::ostringstream value; value << std::fixed << std::setprecision(1) << it->second;
-        filename += it->first + "=" + value.str() + "\n ";
-    }
-
-    for (int i = 0; i < sp.size(); i++) {
-        std::ostringstream niche_stream; 
-        for (int j=0; j<sp[i].niche.parameters.size(); j++){
-            niche_stream << std::fixed << std::setprecision(1) << sp[i].niche.parameters[j];
-            if (j!=sp[i].niche.parameters.size()-1){niche_stream<<",";}
-        }
-        filename += sp[i].name + ":[{" + niche_stream.str() + "}," + to_string(sp[i].diffusion_speed) + "]";
-        if (i<sp.size()-1){filename += "_";} else {filename+="\n ";}
-    }
-    
-    return(filename);
-}
-
-//Convert the repartition to a pixel array
-tuple<sf::Uint8*, string, string, sf::Color, sf::Color> repartitionToPixel(const Environment& env){
-
-    //Create the color palette
-    Vecteur<Vecteur<int>> colorMap(env.species.size(), Vecteur<int> ({0, 0, 0, 255}));
-    for(int i=0 ; i<env.species.size(); i++)
-    {
-        if (i==0){colorMap[i][0]=100; colorMap[i][1]=175; colorMap[i][2]=50;}
-        else if (i==1){colorMap[i][0]=225; colorMap[i][1]=216; colorMap[i][2]=75;}
-        else if (i==2){colorMap[i][0]=150; colorMap[i][1]=175; colorMap[i][2]=100;} //To comment if we want to look at infant
-        else if (i!=0 & i!=1){
-            colorMap[i][2]=floor((i+1)*255/env.species.size());
-        }
-    }
-
-    //Fill in a pixel array with the corresponding colormap
-    Vecteur<Vecteur<int>> pixelArray(env.m*env.n, Vecteur<int> ({0, 0, 0, 255}));
-
-    for (int i=0; i<env.m; i++){
-        for (int j=0; j<env.n; j++){
-            if (env.repartition[i*env.n+j].size()!=0){
-                int k = (find(env.species.begin(), env.species.end(), (env.repartition[i*env.n+j][0])) - env.species.begin());
-                pixelArray[i*env.n+j][0] = colorMap[k][0];
-                pixelArray[i*env.n+j][1] = colorMap[k][1];
-                pixelArray[i*env.n+j][2] = colorMap[k][2];
-            }   
-        }
-    }
-
-    //Convert the pixel array to an sf::Uint8 array
-    sf::Uint8* pixels = new sf::Uint8[env.m * env.n * 4];
-    for (unsigned int i = 0; i < env.m * env.n; ++i) {
-        pixels[i * 4] = pixelArray[i][0];     // Red
-        pixels[i * 4 + 1] = pixelArray[i][1]; // Green
-        pixels[i * 4 + 2] = pixelArray[i][2]; // Blue
-        pixels[i * 4 + 3] = pixelArray[i][3]; // Alpha
-    }
-    
-    return(tuple<sf::Uint8*, string, string, sf::Color, sf::Color> (pixels, env.species[0].name, env.species[env.species.size()-1].name, sf::Color(colorMap[0][0],colorMap[0][1],colorMap[0][2],colorMap[0][3]), sf::Color(colorMap[colorMap.size()-1][0], colorMap[colorMap.size()-1][1], colorMap[colorMap.size()-1][2], colorMap[colorMap.size()-1][3])));
-}
-
-//Convert the vectors to a pixel array
-template<typename T1>
-tuple<sf::Uint8*, string, string, sf::Color, sf::Color> changeToPixel(vector<T1> x){
-
-    //Fill the with intensity depending on the value of x[i]
-    Vecteur<Vecteur<int>> pixelArray(x.size(), Vecteur<int> ({255, 255, 255, 255}));
-
-    //Get the maximum of x to handle intensity levels
-    float xMax = *max_element(x.begin(), x.end());
-    float xMin = *min_element(x.begin(), x.end());
-
-    //Fill the pixel array
-    for (int i=0; i<x.size(); i++){
-        pixelArray[i][1] = (1-x[i]/xMax) * 255;
-        pixelArray[i][2] = (1-x[i]/xMax) * 255;
-    }
-
-    //Convert the pixel array to an sf::Uint8 array
-    sf::Uint8* pixels = new sf::Uint8[x.size() * 4];
-    for (unsigned int i = 0; i < x.size(); ++i) {
-        pixels[i * 4] = pixelArray[i][0];     // Red
-        pixels[i * 4 + 1] = pixelArray[i][1]; // Green
-        pixels[i * 4 + 2] = pixelArray[i][2]; // Blue
-        pixels[i * 4 + 3] = pixelArray[i][3]; // Alpha
-    }
-    
-    return(tuple<sf::Uint8*, string, string, sf::Color, sf::Color> (pixels, to_string(xMin), to_string(xMax), sf::Color(255, 255, 255, 255), sf::Color(255, 0, 0, 255)));
-}
-
-//Convert the environmental conditions to a pixel array
-tuple<sf::Uint8*, string, string, sf::Color, sf::Color> envToPixel(const vector<VariableEnv<Vecteur<float>>>& x, int dimension){
-
-    //Fill the with intensity depending on the value of x[i]
-    Vecteur<Vecteur<int>> pixelArray(x.size(), Vecteur<int> ({255, 255, 255, 255}));
-
-    //Get the maximum and minimum of x to handle intensity levels
-    float xMax(-10000);
-    float xMin(10000);
-    for (int i=0; i<x.size(); i++){
-        if ((x[i].parameters)[dimension] < xMin){
-            xMin = (x[i].parameters)[dimension];
-        }
-        if ((x[i].parameters)[dimension] > xMax){
-            xMax = (x[i].parameters)[dimension];
-        }
-    }
-
-    //Fill the pixel array
-    for (int i=0; i<x.size(); i++){
-        pixelArray[i][1] = (1-abs(x[i].parameters[dimension]-xMin)/abs(xMax-xMin)) * 255;
-        pixelArray[i][2] = (1-abs(x[i].parameters[dimension]-xMin)/abs(xMax-xMin)) * 255;
-    }
-
-    //Convert the pixel array to an sf::Uint8 array
-    sf::Uint8* pixels = new sf::Uint8[x.size() * 4];
-    for (unsigned int i = 0; i < x.size(); ++i) {
-        pixels[i * 4] = pixelArray[i][0];     // Red
-        pixels[i * 4 + 1] = pixelArray[i][1]; // Green
-        pixels[i * 4 + 2] = pixelArray[i][2]; // Blue
-        pixels[i * 4 + 3] = pixelArray[i][3]; // Alpha
-    }
-    
-    return(tuple<sf::Uint8*, string, string, sf::Color, sf::Color> (pixels, to_string(xMin), to_string(xMax), sf::Color(255, 255, 255, 255), sf::Color(255, 0, 0, 255)));
-}
-
-
-//======================================================================
-// Member functions
-//======================================================================
-
-//float unitEnv, int m, float a, float b,
-//Constructor from functors only
-Environment::Environment(vector<Population> sp, map<string,float> parameters, string filename, string genType, string repType, string variability="variable") : numberOfChanges(int(parameters["m"]*parameters["n"]), 0)
-{   
-    //Extract the parameters
-    n = parameters["n"];    
-    m = parameters["m"];               
-    if (parameters.find("unit") != parameters.end()){envDilatation = parameters["unit"];} 
-    if (parameters.find("envDilatation") != parameters.end()){envDilatation = parameters["envDilatation"];}        
-    if (parameters.find("envDelay") != parameters.end()){envDelay = parameters["envDelay"];}
-    if (parameters.find("distMean") != parameters.end()){distMean = parameters["distMean"];} 
-    if (parameters.find("distVar") != parameters.end()){distVar = parameters["distVar"];} 
-    if (parameters.find("percolationProbability") != parameters.end()){percolationProbability = parameters["percolationProbability"];} 
-    envType = variability;
-
-    //Construction of the environmental matrix
-    conditions.resize(m*n);
-    envFunctor intialEnv; 
-    intialEnv(conditions, parameters, genType);
-
-    //Species
-    species = sp;
-
-    //Construction of the intial repartition
-    repartition.resize(m*n);
-    repFunctor initialRep;
-    initialRep(repartition, m, n, sp, repType);
-
-    //Add the parameters and species used in the name of the environment
-    name = makeName(filename, parameters, sp);
-
-    //Make the adaptationScore grid of each species if the environment is constant (otherwise useless)
-    if(envType=="constant")
-    {
-        for (int i=0; i<sp.size(); i++)
-        {
-            adaptationScoreFunctor test;
-            adaptationScores.insert({sp[i].name,test(conditions, sp[i], m ,n)});
-        }
-    }
-}
-
-//Constructor from functors and image to set environmental parameters
-Environment::Environment(const sf::Image& image, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability="variable") : numberOfChanges(int(parameters["m"]*parameters["n"]), 0)
-{   
-    //Extract the parameters
-    n = parameters["n"];    
-    m = parameters["m"];
-    if (parameters.find("unit") != parameters.end()){envDilatation = parameters["unit"];} 
-    if (parameters.find("envDilatation") != parameters.end()){envDilatation = parameters["envDilatation"];}        
-    if (parameters.find("envDelay") != parameters.end()){envDelay = parameters["envDelay"];}
-    if (parameters.find("distMean") != parameters.end()){distMean = parameters["distMean"];} 
-    if (parameters.find("distVar") != parameters.end()){distVar = parameters["distVar"];}
-    envType = variability;
-
-    //Construction of the environmental matrix
-    conditions.resize(m*n);
-    envFunctor intialEnv;
-    intialEnv(conditions, m, n, image);
-
-    //Species
-    species = sp;
-
-    //Construction of the intial repartition
-    repartition.resize(m*n);
-    repFunctor initialRep;
-    initialRep(repartition, m, n, sp, repType);
-
-    //Add the parameters and species used in the name of the environment
-    name = makeName(filename, parameters, sp);
-
-    //Make the adaptationScore grid of each species
-    for (int i=0; i<sp.size(); i++)
-    {
-        adaptationScoreFunctor test;
-        adaptationScores.insert({sp[i].name,test(conditions, sp[i], m ,n)});
-    }
-}
-
-//Constructor from functors and two images to set environmental parameters
-Environment::Environment(const sf::Image& image1, const sf::Image& image2, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability="variable") : numberOfChanges(int(parameters["m"]*parameters["n"]), 0)
-{   
-    //Extract the parameters
-    n = parameters["n"];    
-    m = parameters["m"];
-    if (parameters.find("unit") != parameters.end()){envDilatation = parameters["unit"];} 
-    if (parameters.find("envDilatation") != parameters.end()){envDilatation = parameters["envDilatation"];}        
-    if (parameters.find("envDelay") != parameters.end()){envDelay = parameters["envDelay"];}
-    if (parameters.find("distMean") != parameters.end()){distMean = parameters["distMean"];} 
-    if (parameters.find("distVar") != parameters.end()){distVar = parameters["distVar"];}
-    envType = variability;
-
-    //Construction of the environmental matrix
-    conditions.resize(m*n);
-    envFunctor intialEnv;
-    intialEnv(conditions, m, n, image1, image2);
-
-    //Species
-    species = sp;
-
-    //Construction of the intial repartition
-    repartition.resize(m*n);
-    repFunctor initialRep;
-    initialRep(repartition, m, n, sp, repType);
-
-    //Add the parameters and species used in the name of the environment
-    name = makeName(filename, parameters, sp);
-
-    //Make the adaptationScore grid of each species
-    for (int i=0; i<sp.size(); i++)
-    {
-        adaptationScoreFunctor test;
-        adaptationScores.insert({sp[i].name,test(conditions, sp[i], m ,n)});
-    }
-}
-
-//Diffusion of the species on the grid (determinist)
-Environment Environment::migration()
-{
-    //New environment
-    Environment newEnv(*this);
-
-    for (int i=0; i<this->m; i++){
-        for (int j=0; j<this->n; j++){
-            if (this->repartition[i*this->n+j].size()!=0)
-            {
-                for (int k=0; k<=(this->repartition[i*this->n+j][0]).diffusion_speed; k++){
-                    for (int l=0; l<=(this->repartition[i*this->n+j][0]).diffusion_speed-k; l++){
-                        if ((i+l < this->m) and (j+k < this->n))
-                        {
-                        newEnv.repartition[(i+l)*this->n+k+j].push_back(this->repartition[i*this->n+j][0]);
-                        }
-                        if ((i-l >= 0) and (j-k >= 0))
-                        {
-                        newEnv.repartition[(i-l)*this->n-k+j].push_back(this->repartition[i*this->n+j][0]);
-                        }
-                        if ((i+l < this->m) and (j-k >= 0))
-                        {
-                        newEnv.repartition[(i+l)*this->n-k+j].push_back(this->repartition[i*this->n+j][0]);
-                        }
-                        if ((i-l >= 0) and (j+k < this->n))
-                        {
-                        newEnv.repartition[(i-l)*this->n+k+j].push_back(this->repartition[i*this->n+j][0]);
-                        }
-                    }
-                }
-            }
-        }
-    }
-    
-    return newEnv;
-}
-
-//Selection of the best adapted Population in each node of the grid (determinist)
-Environment Environment::selection(){
-
-    //New environment
-    Environment newEnv(*this);
-
-    //If the environnement is variable (changing with time) re-calculate everytime all the scores
-    if (this->envType=="variable"){
-        for (int i=0; i<this->m; i++){
-            for (int j=0; j<this->n; j++){
-                if (this->repartition[i*this->n+j].size()!=0){
-                    gaussianScore scoreFunction;
-                    float score = scoreFunction(this->conditions[i*this->n+j].parameters, this->repartition[i*this->n+j][0]);
-                    int ind(0);
-                    
-                    for (int k=1; k<this->repartition[i*this->n+j].size(); k++){
-                        float score_k = scoreFunction(this->conditions[i*this->n+j].parameters, this->repartition[i*this->n+j][k]);
-                        if (score_k > score)
-                        {
-                            ind = k;
-                            score = score_k;
-                        }
-                    }
-                    
-                    if (newEnv.repartition[i*this->n+j].size()!=0){
-                        if (ind!=0)
-                        {
-                            newEnv.numberOfChanges[i*this->n+j]+=1;
-                        }
-
-                        Vecteur<Population> bestSp({this->repartition[i*this->n+j][ind]});
-                        newEnv.repartition[i*this->n+j]=bestSp;
-                    }
-                }
-            }
-        }
-    }
-
-    //If the environnement is constant use pre-calculated scores
-    else if (this->envType=="constant"){
-        for (int i=0; i<this->m; i++){
-            for (int j=0; j<this->n; j++){
-                if (this->repartition[i*this->n+j].size()!=0){
-                    float score = this->adaptationScores[this->repartition[i*this->n+j][0].name][i*this->n+j];
-                    int ind(0);
-                    
-                    for (int k=1; k<this->repartition[i*this->n+j].size(); k++)
-                    {
-                        if (this->adaptationScores[this->repartition[i*this->n+j][k].name][i*this->n+j] > score)
-                        {
-                            ind = k;
-                            score = this->adaptationScores[this->repartition[i*this->n+j][k].name][i*this->n+j];
-                        }
-                        
-                    }
-                    
-                    if (newEnv.repartition[i*this->n+j].size()!=0)
-                    {
-                        if (ind!=0)
-                        {
-                            newEnv.numberOfChanges[i*this->n+j]+=1;
-                        }
-
-                        Vecteur<Population> bestSp({this->repartition[i*this->n+j][ind]});
-                        //cout << bestSp;
-                        newEnv.repartition[i*this->n+j]=bestSp;
-                    }
-                }
-            }
-        }
-    }
-    
-    return newEnv;
-}
-
-//Change in the environment according to the functor : f_t(conditions)
-Environment Environment::environmentalChange(float t){   
-    for (int i=0; i<this->m; i++){
-        for (int j=0; j<this->n; j++){
-            envChangeFunctor f;
-            this->conditions[i*this->n+j] = f(this->unit, i, j, this->m, this->n, t, this->envDilatation, this->envDelay);
-        }
-    }
-    return *this;
-} 
-
-//Count the number of individuals in each populations
-Vecteur<float> Environment::countPopulations(){
-    Vecteur<float> counts(this->species.size(),0);
-    for (int i=0; i<this->m; i++){
-        for (int j=0; j<this->n; j++){
-            if (this->repartition[i*this->n+j].size()!=0){
-                counts[int(find(this->species.begin(), this->species.end(), (this->repartition[i*this->n+j][0])) - this->species.begin())]+=1;
-            }
-        }
-    }
-    return counts;
-}
-
-//Custom display of the environment
-void Environment::display(string type, int envDimension){
-    tuple<sf::Uint8*, string, string, sf::Color, sf::Color>  repartitionPixels = repartitionToPixel(*this);
-    tuple<sf::Uint8*, string, string, sf::Color, sf::Color>  changePixels = changeToPixel(this->numberOfChanges);
-    tuple<sf::Uint8*, string, string, sf::Color, sf::Color>  envPixels = envToPixel(this->conditions, envDimension);
-
-    imagePlot(repartitionPixels, 0, this->name+"repartition.png", this->m, this->n);
-    imagePlot(changePixels, 0, this->name + "numberChange.png", this->m, this->n);
-    imagePlot(envPixels, 0, this->name + "environment dimension "+to_string(envDimension)+".png", this->m, this->n);
-
-    mergeImage(this->name + "environment dimension "+to_string(envDimension)+".png", this->name+"repartition.png", this->name + "numberChange.png", this->name+"merged_t=0.png");
-}
-
-//Custom display of the environment with time in the name
-void Environment::display(string type, int envDimension, int i){
-
-    //Generate pixel array
-    tuple<sf::Uint8*, string, string, sf::Color, sf::Color>  repartitionPixels = repartitionToPixel(*this);
-    tuple<sf::Uint8*, string, string, sf::Color, sf::Color>  changePixels = changeToPixel(this->numberOfChanges);
-    tuple<sf::Uint8*, string, string, sf::Color, sf::Color>  envPixels = envToPixel(this->conditions, envDimension);
-
-    //Filenames
-    string repFile = this->name + "repartition \n t=" + to_string(i) + ".png";
-    string changeFile = this->name + "numberChange \n t=" + to_string(i) + ".png";
-    string envFile = this->name + "environment dimension " + to_string(envDimension) +"\n t=" + to_string(i) + ".png";
-
-    //Save image
-    imagePlot(repartitionPixels, i, repFile, this->m, this->n);
-    imagePlot(changePixels, i, changeFile, this->m, this->n);
-    imagePlot(envPixels, i, envFile, this->m, this->n);
-
-    mergeImage(envFile, repFile, changeFile, this->name+"_merged="+to_string(i)+".png");
-}
+ostream& operator <<(ostream & out, const Environment& E);                               //Print an environment in the terminal
+string makeName(string filename, map<string,float> parameters, vector<Population> sp);  //Name of the environment with its parameters
 
 #endif
-
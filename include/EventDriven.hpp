@@ -0,0 +1,57 @@
+#ifndef DEF_EVENTDRIVEN_HPP
+#define DEF_EVENTDRIVEN_HPP
+
+#include <vector>
+#include <string>
+#include "Environment.hpp"
+#include "Vecteur.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Event driven engine of a determinist run in a constant environment.
+//
+// With a determinist migration and selection and precomputed adaptation scores, the
+// occupant of a node only changes for a species with a strictly better score, so a
+// species that lost a node never comes back. Then the only arrivals that can change a
+// node come from the nodes whose occupant changed at the previous iteration (the
+// frontier); the other arrivals always lose against the occupant.
+//
+// Each iteration only propagates the frontier, in the order of Environment::migration
+// (sources in row-major order, the species using the minimum filter included), so
+// the ties are broken exactly as in the iterative run.
+// Every node changes at most once per species : the whole run costs a number of
+// arrivals proportional to the number of nodes, whatever the number of iterations.
+//
+//======================================================================
+//                     Class EventDriven definition
+//======================================================================
+
+class EventDriven
+{
+public:
+    vector<int> occupant;                       //Index of the species occupying each node (-1 if empty)
+    vector<int> frontier;                       //Nodes whose occupant changed at the last iteration (row-major order)
+    Vecteur<float> counts;                      //Number of nodes of each species
+    vector<const ScoreLayer*> scores;           //Adaptation scores of each species
+    vector<int> fold;                           //Map of the padded lattice to the nodes (see haloMap)
+
+    //Constructors
+    EventDriven(){};
+    EventDriven(Environment& env);
+
+    //Member functions
+    int advance(Environment& env);              //One iteration, returns the number of nodes that changed
+
+private:
+    vector<int> touched;                        //Nodes reached at this iteration
+    vector<int> first;                          //First candidate of each reached node
+    vector<int> best;                           //Best candidate of each reached node
+    vector<int> stamp;                          //Iteration of the last arrival on each node
+    int iteration = 0;                          //Number of iterations done
+};
+
+#endif
@@ -7,13 +7,14 @@
 #include <list>
 #include <map>
 #include <cmath>
-#include <SFML/Graphics.hpp>
 #include <math.h>
 #include <string>
 #include "VariableEnv.hpp"
 #include "Population.hpp"
-#include "Environment.hpp"
 #include "Vecteur.hpp"
+#include "Random.hpp"
+#include "Stencil.hpp"
+#include "Raster.hpp"
 
 using namespace std;
 
@@ -23,69 +24,20 @@ using namespace std;
 //
 // Repertory of functors used to generate the environnement and compute adaptation scores.
 //
+// The definitions are in src/core/Functor.cpp.
+//
 //======================================================================
 //                    Linear algebra functions toolbox 
 //======================================================================
 
 // Perform Cholesky decomposition of a *symmetric positive definite* matrix A
-void choleskyDecomposition(const Vecteur<Vecteur<float>> &A, Vecteur<Vecteur<float>> &L){
-  int n = A.size();
-  L = Vecteur<Vecteur<float>>(n, Vecteur<float>(n, 0.0f));
-
-  for (int i = 0; i < n; ++i){
-    for (int j = 0; j <= i; ++j){
-      float sum = 0.0f;
-      // Calculate the sum for the current element
-      for (int k = 0; k < j; ++k){
-        sum += L[i][k] * L[j][k];
-      }
-      if (i == j){
-        // Diagonal elements
-        L[i][j] = sqrt(A[i][i] - sum);
-      } 
-      else{
-        // Off-diagonal elements
-        L[i][j] = (A[i][j] - sum) / L[j][j];
-      }
-    }
-  }
-}
+void choleskyDecomposition(const Tolerance &A, Tolerance &L);
 
 // Compute the determinant of A = L^T * L
-float determinant(const Vecteur<Vecteur<float>> &L){
-  float det = 1.0f;
-  for (int i = 0; i < L.size(); ++i){
-    det *= L[i][i];
-  }
-  return det * det; // Determinant of A = (det(L))^2
-}
+float determinant(const Tolerance &L);
 
 // Solve Ax=b using Cholesky decomposition L of A
-Vecteur<float> solveCholesky(const Vecteur<Vecteur<float>> &L, const Vecteur<float> &b){
-  int n = b.size();
-  Vecteur<float> y(n, 0.0f);
-  Vecteur<float> x(n, 0.0f);
-
-  // Forward substitution to solve Ly = b
-  for (int i = 0; i < n; ++i){
-    float sum = 0.0f;
-    for (int j = 0; j < i; ++j){
-      sum += L[i][j] * y[j];
-    }
-    y[i] = (b[i] - sum) / L[i][i];
-  }
-
-  // Backward substitution to solve L^T x = y
-  for (int i = n - 1; i >= 0; --i){
-    float sum = 0.0f;
-    for (int j = i + 1; j < n; ++j){
-      sum += L[j][i] * x[j];
-    }
-    x[i] = y[i] - sum;
-  }
-
-  return x;
-}
+Conditions solveCholesky(const Tolerance &L, const Conditions &b);
 
 //======================================================================
 //                           Class envChangeFunctor 
@@ -95,9 +47,9 @@ Vecteur<float> solveCholesky(const Vecteur<Vecteur<float>> &L, const Vecteur<flo
 class envChangeFunctor
 {
 public:
-  VariableEnv<Vecteur<float>> operator()(float unit, float i, float j, float m, float n, float t, float a, float b) const
+  VariableEnv<Conditions> operator()(float unit, float i, float j, float m, float n, float t, float a, float b) const
   {
-    VariableEnv<Vecteur<float>> newEnv(Vecteur<float>({0.5f*sin(a*i*unit+b*t)+0.5f})); // *CAREFUL* match dimension with number of env variables
+    VariableEnv<Conditions> newEnv(Conditions({0.5f*sin(a*i*unit+b*t)+0.5f})); // *CAREFUL* match dimension with number of env variables
     return VariableEnv(newEnv);
   }
 };
@@ -110,60 +62,27 @@ public:
 class repFunctor
 {
 public:
-  vector<vector<Population>>& operator()(vector<vector<Population>>& rep, float m, int n, vector<Population> sp, string gen)
-  {
-    if (gen == "bottomStart"){
-      for (int i=0; i<m; i++){
-        for (int j=0; j<n; j++){
-          if (i==m-1) {rep[i*n+j].push_back(sp[0]);} 
-          else {rep[i*n+j].push_back(sp[1]);} 
-        }
-      }
-    }
-    
-    if (gen == "centralStart"){
-      int mid_i = m/2;
-      int mid_j = n/2;
-      for (int i=0; i<m; i++){
-        for (int j=0; j<n; j++){ 
-          if ((i==mid_i-1) & (j==mid_j-1)) {rep[i*n+j].push_back(sp[0]);}
-          else {rep[i*n+j].push_back(sp[1]);} 
-        }
-      }
-    }
-
-    if (gen == "oppositeCornerStart"){
-      rep[(m-1)*n+(n-1)].push_back(sp[1]);
-      rep[0].push_back(sp[0]);
-    }
+  vector<vector<int>>& operator()(vector<vector<int>>& rep, float m, int n, vector<Population> sp, string gen, const CounterRNG& rng = CounterRNG());
+};
 
-    else if (gen == "pointStart"){
-      for (int i=0; i<m; i++){
-        for (int j=0; j<n; j++){
-          rep[i*n+j].push_back(sp[2]); //Mask Population
-        }
-      }
-      
-      // Initialize random number generator with a seed to ensure reprodicability
-      std::mt19937 rng(1);
-      std::uniform_int_distribution<int> dist_n(0, n-1);
-      std::uniform_int_distribution<int> dist_m(0, m-1);
+//======================================================================
+//                           Class firstSourceFunctor
+//     (First node of a species reaching every node within a diffusion speed)
+//======================================================================
 
-      // Place n sub-population uniformally distributed on the grid
-      for(int k=0; k<n; k++){
-        int i = dist_m(rng);
-        int j = dist_n(rng);
-        rep[i*n+j].pop_back();
-        rep[i*n+j].push_back(sp[0]); 
-        
-        int i_bis = dist_m(rng);
-        int j_bis = dist_n(rng);
-        rep[i_bis*n+j_bis].pop_back();
-        rep[i_bis*n+j_bis].push_back(sp[1]); 
-      }
-    }
-    return(rep);
-  }
+// Smallest row-major index of the nodes occupied by a species whose neighbourhood of
+// radius speed ("vonNeumann" : L1 distance, "moore" : L-infinity distance) contains the
+// node, m*n if the node is not reached : the species arrives on the node at the same
+// place in the order of the sources as with the stencil of the speed.
+// A minimum filter over a window of the lattice padded by the halo (fold : see haloMap),
+// linear in the number of nodes whatever the speed : along the rows and the columns for
+// "moore", along the diagonals for "vonNeumann" (the diamond is the union of two squares
+// of the diagonal lattices).
+class firstSourceFunctor
+{
+public:
+  Vecteur<int> operator()(const vector<vector<int>>& rep, const Population& sp, int m0, int n0, string neighbourhood,
+                          const vector<int>& fold, int halo, int speed);
 };
 
 //======================================================================
@@ -174,64 +93,27 @@ public:
 class envFunctor
 {
 public:
-  vector<VariableEnv<Vecteur<float>>>& operator()(vector<VariableEnv<Vecteur<float>>>& env, map<string,float> parameters, string gen)
-  {
-    if (gen=="function"){
-      for (int i=0; i<parameters["m"]; i++){
-        for (int j=0; j<parameters["n"]; j++){
-          env[i*parameters["n"]+j].parameters=Vecteur<float>({0});
-        }
-      }
-    }
-    
-    if (gen=="percolation"){
-      std::random_device rd{};
-      std::mt19937 gen{rd()};
-      for (int i=0; i<parameters["m"]; i++){
-        for (int j=0; j<parameters["n"]; j++){
-          bernoulli_distribution ber_dist(parameters["percolationProbability"]); //Site percolation critical value 0.59274605079210 from https://arxiv.org/abs/1507.03027
-          env[i*parameters["n"]+j].parameters=Vecteur<float>({1.f-float(ber_dist(gen))});
-        }
-      }
-    }
+  vector<VariableEnv<Conditions>>& operator()(vector<VariableEnv<Conditions>>& env, map<string,float> parameters, string gen);
 
-    else if(gen=="normal"){
-      for (int i=0; i<parameters["m"]; i++){
-        for (int j=0; j<parameters["n"]; j++){
-          std::random_device rd{};
-          std::mt19937 gen{rd()}; //Using generation 32-bit Mersenne Twister by Matsumoto and Nishimura, 1998 (one of the best)
-          normal_distribution<float> dist(parameters["distMean"],sqrt(parameters["distVar"]));
-          env[i*parameters["n"]+j].parameters=Vecteur<float>({float(dist(gen)), float(dist(gen)), float(dist(gen))});  
-        }
-      }
-    }
-    return(env);
-  }
+  //Levels of a percolation environment (draw of each node, conditions of levelConditions)
+  vector<uint16_t>& operator()(vector<uint16_t>& levels, map<string,float> parameters, string gen);
 
-  //Environment from a single image 
-  vector<VariableEnv<Vecteur<float>>>& operator()(vector<VariableEnv<Vecteur<float>>>& env, int m, int n, const sf::Image& image)
-  {
-    for (int y = 0; y < m; ++y) {
-      for (int x = 0; x < n; ++x) {
-        sf::Color color = image.getPixel(x, y);
-        env[y*n+x].parameters=Vecteur<float>({(-1.f*static_cast<float>(color.r)+255.f)/255.f*15.f});
-      }
-    }
-    return env;
-  }
+  //Environment from a single image (red channel : depth)
+  vector<VariableEnv<Conditions>>& operator()(vector<VariableEnv<Conditions>>& env, int m, int n, const Raster& image);
 
-  //Environment from two images
-  vector<VariableEnv<Vecteur<float>>>& operator()(vector<VariableEnv<Vecteur<float>>>& env, int m, int n, const sf::Image& image1,  const sf::Image& image2)
-  {
-    for (int y = 0; y < m; ++y) {
-      for (int x = 0; x < n; ++x) {
-        sf::Color color1 = image1.getPixel(x, y);
-        sf::Color color2 = image2.getPixel(x, y);
-        env[y*n+x].parameters=Vecteur<float>({(-1.f*static_cast<float>(color1.r)+255.f)/255.f*15.f, static_cast<float>(color2.r)/255.f*10.f});
-      }
-    }
-    return env;
-  }
+  //Environment from two images (red channels : depth and vegetation cover)
+  vector<VariableEnv<Conditions>>& operator()(vector<VariableEnv<Conditions>>& env, int m, int n, const Raster& image1,  const Raster& image2);
+
+  //Conditions of a single node (y,x) from the images (environments built node by node, see OutOfCore.hpp)
+  Conditions operator()(int y, int x, const Raster& image);
+  Conditions operator()(int y, int x, const Raster& image1,  const Raster& image2);
+
+  //Conditions of a pixel value (one image), of a pair of pixel values (two images)
+  Conditions operator()(uint8_t red);
+  Conditions operator()(uint8_t red1, uint8_t red2);
+
+  //Conditions of a level (pixel value for 256 levels, pair of pixel values for 65536, percolation draw for 2)
+  Conditions levelConditions(int level, int levelCount);
 };
 
 //======================================================================
@@ -242,26 +124,7 @@ public:
 class gaussianScore 
 {
 public:
-  float operator()(const Vecteur<float> &x, const Population &sp) {
-    int k = x.size();
-    
-    Vecteur<Vecteur<float>> L;
-    choleskyDecomposition(sp.tolerance, L);
-    float toleranceDet = determinant(L);
-
-    // Compute the normalization constant
-    float norm_const = 1.f / pow(2.f * M_PI, k / 2.f) / std::sqrt(toleranceDet);
-
-    // Compute the exponent term
-    Vecteur<float> diff = x - sp.niche.parameters;
-
-    Vecteur<float> temp = solveCholesky(L, diff);
-    float exponent =  diff|temp;
-    exponent *= -0.5f;
-
-    // Compute the Gaussian value
-    return norm_const * exp(exponent);
-  }
+  float operator()(const Conditions &x, const Population &sp);
 };
 
 //======================================================================
@@ -272,16 +135,10 @@ public:
 class adaptationScoreFunctor
 {
 public:
-  Vecteur<float> operator()(const vector<VariableEnv<Vecteur<float>>> &cond, Population sp, int m, int n) {
-    gaussianScore func;
-    Vecteur<float> grid(m*n);
-    for (int i=0; i<m; i++){
-      for (int j=0; j<n; j++){
-        grid[i*n+j] = func(cond[i*n+j].parameters, sp);
-      }
-    }
-    return(grid);
-  }
+  Vecteur<float> operator()(const vector<VariableEnv<Conditions>> &cond, Population sp, int m, int n);
+
+  //Table of the scores of the levels of an environment built from images (256 : one image, 65536 : two images, see ScoreLayer.hpp)
+  Vecteur<float> operator()(const vector<uint16_t> &levels, int levelCount, Population sp);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,55 @@
+#ifndef DEF_MEMORY_HPP
+#define DEF_MEMORY_HPP
+
+#include <atomic>
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Opt-in accounting of the heap allocations (compile with -DMEMORY_TRACKING,
+// make MEMORY=1).
+//
+// The global operator new/delete are replaced (src/core/Memory.cpp) to count the
+// allocations, the allocated bytes, the live bytes and their high-water mark. Each
+// block carries a small header with its size so the live bytes stay exact. Without
+// the flag nothing is replaced and the counters stay at zero.
+//
+// A checkpoint restarts the high-water mark of the live bytes, memorySince reads it
+// and gives it back to the enclosing checkpoint, so the checkpoints can be nested
+// (an iteration and its phases). The peak resident memory of the process is read
+// from getrusage, once per run.
+//
+//======================================================================
+//                          Counters
+//======================================================================
+
+struct MemoryCounters
+{
+    atomic<long> allocations{0};        //Number of allocations
+    atomic<long> bytes{0};              //Allocated bytes
+    atomic<long> liveBytes{0};          //Bytes currently allocated
+    atomic<long> peakLiveBytes{0};      //High-water mark of liveBytes (can be reset)
+};
+
+extern MemoryCounters memoryCounters;
+
+//Snapshot of the counters, or difference between two snapshots
+struct MemoryRecord
+{
+    long allocations = 0;               //Number of allocations
+    long bytes = 0;                     //Allocated bytes
+    long peakLiveBytes = 0;             //Largest amount of live bytes (checkpoint : high-water mark of the enclosing checkpoint)
+};
+
+//======================================================================
+//                          Functions
+//======================================================================
+
+long peakResidentMemory();                              //Peak resident memory of the process (kB)
+MemoryRecord memoryCheckpoint();                        //Current state of the counters, restarts the high-water mark
+MemoryRecord memorySince(const MemoryRecord& start);    //What happened since the checkpoint, restores the high-water mark
+
+#endif
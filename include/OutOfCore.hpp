@@ -0,0 +1,102 @@
+#ifndef DEF_OUTOFCORE_HPP
+#define DEF_OUTOFCORE_HPP
+
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+#include "Environment.hpp"
+#include "TemporalBlocking.hpp"
+#include "Vecteur.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Out-of-core run of a lattice larger than the memory (regional maps at full resolution).
+//
+// An Environment keeps its conditions, repartition, numbers of changes and scores in
+// memory for the whole lattice. Here every layer is a file of a directory, mapped in
+// memory (Linux), and stored tile after tile : the nodes of a square tile are
+// contiguous, so a tile and its halo only touch a few pages of each file. The system
+// pages the tiles in and out as the sweep advances; the sweep announces the next tile
+// (madvise) and releases the tiles that are not active at the next iteration.
+//
+// Files : occupant.bin and changes.bin (two buffers each, the current one of every
+// tile is kept in memory), scores.bin (S floats per node), conditions.bin (D floats
+// per node) and colonisation.bin. Only the species and parameters of the run are kept
+// in memory (rule, an Environment without the layers of the nodes).
+//
+// An iteration advances every active tile with the kernel of TemporalBlocking (one
+// iteration per sweep, halo of R nodes). With a determinist migration and selection a
+// tile can only change if a node at most R nodes away changed at the previous
+// iteration, so only the tiles reached by the invasion front are processed. Stochastic
+// rules draw again at every iteration and process every tile. The conditions do not
+// change during the run (scores computed once). The result is exactly the one of a
+// Simulation of the same environment.
+//
+//======================================================================
+//                      Class OutOfCore definition
+//======================================================================
+
+class OutOfCore
+{
+public:
+    Environment rule;                           //Species and parameters of the run (lattice m x n, without the layers of the nodes)
+    string directory;                           //Directory of the tile files
+    int tileSize = 256;                         //Side of the tiles
+    int timeBeforeStationarity = 0;             //Number of iterations before stationarity (as Simulation)
+    Vecteur<float> counts;                      //Number of nodes of each species
+    long processedTiles = 0;                    //Tiles advanced by the last run (over all the iterations)
+
+    //Constructors
+    OutOfCore(vector<Population> sp, map<string,float> parameters, string dir, int side = 256);   //Empty lattice, conditions set with setConditions
+    OutOfCore(const Environment& env, string dir, int side = 256);                                //Layers of an environment
+    OutOfCore(const OutOfCore&) = delete;
+    OutOfCore& operator=(const OutOfCore&) = delete;
+    ~OutOfCore();
+
+    //Member functions
+    void setConditions(const function<Conditions(int,int)>& conditionsAt);     //Conditions and scores of every node (i,j), tile after tile (several threads)
+    void setOccupant(int i, int j, int k);                                          //Initial occupant of a node (index of the species, -1 : empty)
+    int occupantAt(int i, int j) const;                                             //Occupant of a node (index of the species, -1 if empty)
+    int colonisationAt(int i, int j) const;                                         //Iteration at which the node got its last occupant (-1 if never occupied)
+    void run(int nIter);                                                            //Iterations up to stationarity or nIter (as Simulation)
+    void writeBack(Environment& env) const;                                         //Repartition and numbers of changes of an environment of the same size
+
+private:
+    int m = 0;                                  //Number of rows
+    int n = 0;                                  //Number of columns
+    int S = 0;                                  //Number of species
+    int D = 0;                                  //Number of conditions of a node
+    int tileRows = 0;                           //Number of rows of tiles
+    int tileColumns = 0;                        //Number of columns of tiles
+    long nodes = 0;                             //Nodes of the padded tiles (tile after tile)
+    vector<int> current;                        //Buffer holding the current occupants and changes of each tile (0 or 1)
+    vector<char> active;                        //Tiles to advance at the next iteration
+
+    //Mapped files
+    struct MappedFile
+    {
+        void* data = nullptr;
+        size_t bytes = 0;
+    };
+    MappedFile occupantFile, changesFile, scoresFile, conditionsFile, colonisationFile;
+    int* occupant[2];                           //Occupants of the nodes (index of the species, -1 if empty)
+    int* changes[2];                            //Numbers of changes of the nodes
+    float* scores = nullptr;                    //Scores of the species (index address*S+k)
+    float* conditions = nullptr;                //Conditions of the nodes (index address*D+d)
+    int* colonisation = nullptr;                //Colonisation times
+
+    void create(int side);
+    MappedFile mapFile(const string& name, size_t bytes);
+    long address(int i, int j) const;           //Position of a node in the files
+    int tileOf(int i, int j) const;             //Tile of a node
+    void advise(int t, int advice) const;       //Paging advice on the layers of a tile
+    void markNeighbours(int t, const TileKernel& kernel, vector<char>& next) const;
+    int advanceTile(int t, int iteration, const TileKernel& kernel, TileWindow& w, int* delta);
+};
+
+#endif
@@ -16,8 +16,22 @@ using namespace std;
 // Define the class to host population characteristics. 
 // Notably, diffusion speed, name, optimum, tolerance
 //
+// Every Population gets an id when it is built : the names are interned in a registry
+// (same name, same id, as two Populations are the same species if they have the same
+// name). The lattice and the candidate lists of an Environment hold the ids, so the
+// comparisons and the lookups of the species are integer operations. The registry
+// keeps the first Population of each name (species of a node missing from the
+// species list of its Environment).
+//
 // Define additional functions/operators related to Population.
+// (definitions in src/core/Population.cpp)
 //
+//Conditions of a node and optimum of a species (at most MAX_CONDITIONS environmental
+//variables, stored in the object : no allocation, contiguous arrays of conditions)
+const int MAX_CONDITIONS = 4;
+typedef SmallVecteur<float, MAX_CONDITIONS> Conditions;
+typedef SmallVecteur<Conditions, MAX_CONDITIONS> Tolerance;
+
 //======================================================================
 //                  Class Population definition
 //======================================================================
@@ -26,46 +40,28 @@ class Population
 {
 public:
     string name;                            //Name of the Population
-    VariableEnv<Vecteur<float>> niche;      //Optimal growing conditions
+    VariableEnv<Conditions> niche;          //Optimal growing conditions
     int diffusion_speed;                    //Number of case travelled per iterations during diffusion
-    Vecteur<Vecteur<float>> tolerance;      //Tolerance matrix of the Population
+    Tolerance tolerance;                    //Tolerance matrix of the Population
+    int id = -1;                            //Interned identity (index of the name in the registry, -1 if no name)
 
     //Constructors
-    Population(VariableEnv<Vecteur<float>>& v, string Population, int speed, Vecteur<Vecteur<float>> tol);
+    Population(VariableEnv<Conditions>& v, string Population, int speed, Tolerance tol);
     Population(){};
 
     //Member functions
+    static int intern(const Population& sp);        //Id of the name of a Population (registered at its first use, thread-safe)
+    static const Population& registered(int id);    //First Population registered with the name of an id
 
     //Operators
-    bool operator==(const Population &B) const {return(this->name==B.name);}
+    bool operator==(const Population &B) const {return(this->id==B.id);}
 };
 
-//======================================================================
-//                          Member functions
-//======================================================================
-
-Population::Population(VariableEnv<Vecteur<float>>& v, string Population, int speed, Vecteur<Vecteur<float>> tol)
-{
-    niche=v;
-    diffusion_speed=speed;
-    name=Population;
-    tolerance = tol;
-}
-
 //======================================================================
 //                         External functions
 //======================================================================
 
-Population mean(Population A, Population B)
-{
-    VariableEnv newNiche(A.niche.parameters+B.niche.parameters/float(2));
-    Population infant(newNiche,"("+A.name+B.name+")",min(A.diffusion_speed, B.diffusion_speed), A.tolerance);
-    return(infant);
-}
+Population mean(Population A, Population B);                //Hybrid of two populations
+ostream& operator <<(ostream & out, const Population& sp);
 
-ostream& operator <<(ostream & out, const Population& sp)
-{   
-    out << sp.name << ":" << sp.niche ;
-    return out;
-}
-#endif
\ No newline at end of file
+#endif
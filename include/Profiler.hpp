@@ -0,0 +1,114 @@
+#ifndef DEF_PROFILER_HPP
+#define DEF_PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Memory.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Low overhead profiler of the phases of a simulation.
+//
+// The wall time and the number of calls of each phase are accumulated for the
+// whole run and for every iteration. The phases are timed with the macro
+// PROFILE_PHASE(phase), which measures until the end of the enclosing scope.
+//
+// With -DMEMORY_TRACKING (make MEMORY=1) each phase also accumulates the number
+// of heap allocations and the allocated bytes, and keeps the largest amount of
+// live bytes reached during a call (see Memory.hpp).
+//
+// The timers only exist when compiled with -DPROFILING (make PROFILE=1) or
+// -DMEMORY_TRACKING, otherwise PROFILE_PHASE expands to nothing and a Simulation
+// has no profiler.
+//
+//======================================================================
+//                            Phases
+//======================================================================
+
+enum profilePhase
+{
+    MIGRATION_PHASE = 0,       //Environment::migration
+    SELECTION_PHASE,           //Environment::selection
+    TILED_PHASE,               //Migration and selection of several iterations per tile (TemporalBlocking)
+    ENV_CHANGE_PHASE,          //Environment::environmentalChange
+    STATIONARITY_PHASE,        //Copy of the old environment and stationarity check
+    PIXEL_PHASE,               //Conversion of the environment to pixel arrays
+    ENCODING_PHASE,            //Rendering of the images (textures, legend, merge)
+    FILE_IO_PHASE,             //Images written to and read from the disk
+    N_PHASES
+};
+
+const array<string, N_PHASES> phaseNames = {"migration", "selection", "tiledBlock", "environmentalChange", "stationarity",
+                                            "pixelConversion", "imageEncoding", "fileIO"};
+
+//======================================================================
+//                        Class Profiler
+//======================================================================
+
+class Profiler
+{
+public:
+    array<double, N_PHASES> time{};             //Total wall time of each phase (seconds)
+    array<long, N_PHASES> count{};              //Number of calls of each phase
+    array<long, N_PHASES> allocations{};        //Number of heap allocations of each phase (MEMORY_TRACKING)
+    array<long, N_PHASES> allocatedBytes{};     //Allocated bytes of each phase (MEMORY_TRACKING)
+    array<long, N_PHASES> peakLiveBytes{};      //Largest amount of live bytes during a call of each phase (MEMORY_TRACKING)
+    vector<array<double, N_PHASES>> trace;      //Wall time of each phase at each iteration
+    vector<int> traceStep;                      //Iteration of each line of the trace
+
+    //Member functions
+    void add(profilePhase phase, double seconds, long allocs = 0, long bytes = 0, long peak = 0);
+    void newStep(int step);
+    void reset();
+    void report(ostream& out) const;
+    void writeTrace(string filename) const;
+};
+
+//Profiler receiving the measures (set by the running Simulation)
+extern Profiler* activeProfiler;
+
+//======================================================================
+//                        Class ScopedPhase
+//======================================================================
+
+//Timer of a phase from its construction to the end of the scope
+class ScopedPhase
+{
+public:
+    profilePhase phase;
+    chrono::steady_clock::time_point start;
+    MemoryRecord memoryStart;
+
+    ScopedPhase(profilePhase p) : phase(p), start(chrono::steady_clock::now()), memoryStart(memoryCheckpoint()) {};
+    ~ScopedPhase(){
+        MemoryRecord used = memorySince(memoryStart);
+        if (activeProfiler != nullptr){
+            activeProfiler->add(phase, chrono::duration<double>(chrono::steady_clock::now() - start).count(),
+                                used.allocations, used.bytes, used.peakLiveBytes);
+        }
+    }
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if defined(PROFILING) || defined(MEMORY_TRACKING)
+#define PROFILER_ENABLED
+#endif
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_PHASE(phase) ScopedPhase PROFILE_CONCAT(scopedPhase, __LINE__)(phase)
+#else
+#define PROFILE_PHASE(phase)
+#endif
+
+#endif
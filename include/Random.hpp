@@ -0,0 +1,113 @@
+#ifndef DEF_RANDOM_HPP
+#define DEF_RANDOM_HPP
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Counter-based random number generator (Philox4x32-10, Salmon et al. 2011,
+// "Parallel random numbers: as easy as 1, 2, 3").
+//
+// A draw is a pure function of the key (run seed, replicate) and of a counter
+// (stream, step, cell, draw). There is no hidden state: every cell of every step
+// can be drawn independently, in any order, on any thread, and always gives the
+// same value. Each call returns a block of four 32 bits words.
+//
+//======================================================================
+//                        Random streams
+//======================================================================
+
+//Independent sequences for each part of the model (first word of the counter)
+enum rngStream
+{
+    ENV_GENERATION = 0,        //Random environment generation (percolation, normal)
+    INITIAL_REPARTITION = 1,   //Random initial repartition (pointStart)
+    MIGRATION = 2,             //Stochastic migration
+    SELECTION = 3,             //Stochastic selection
+    HYBRIDISATION = 4          //Hybrids of the species meeting in a node
+};
+
+//======================================================================
+//                        Class CounterRNG
+//======================================================================
+
+class CounterRNG
+{
+public:
+    uint32_t seed;          //Seed of the run
+    uint32_t replicate;     //Replicate number (second word of the key)
+
+    //Constructor
+    CounterRNG(uint32_t s = 1, uint32_t r = 0) : seed(s), replicate(r) {};
+
+    //Member functions
+    array<uint32_t,4> block(uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw = 0) const;
+    float uniform(uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw = 0) const;
+    float normal(uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw = 0) const;
+    bool bernoulli(float p, uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw = 0) const;
+    int uniformInt(int lo, int hi, uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw = 0) const;
+
+    //Conversion of a raw word
+    static float toUniform(uint32_t x) {return float(x >> 8) * (1.f / 16777216.f);}            // [0,1)
+    static int toInt(uint32_t x, int lo, int hi) {return lo + int((uint64_t(x) * uint64_t(hi - lo + 1)) >> 32);}  // [lo,hi]
+};
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+//Philox4x32 with 10 rounds
+inline array<uint32_t,4> CounterRNG::block(uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw) const
+{
+    const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+    uint32_t c0 = stream, c1 = step, c2 = cell, c3 = draw;
+    uint32_t k0 = seed, k1 = replicate;
+
+    for (int r=0; r<10; r++){
+        uint64_t p0 = uint64_t(M0) * c0;
+        uint64_t p1 = uint64_t(M1) * c2;
+        uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+        c0 = n0; c1 = uint32_t(p1);
+        c2 = n2; c3 = uint32_t(p0);
+        k0 += W0; k1 += W1;
+    }
+    return {c0, c1, c2, c3};
+}
+
+//Uniform draw in [0,1)
+inline float CounterRNG::uniform(uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw) const
+{
+    return toUniform(block(stream, step, cell, draw)[0]);
+}
+
+//Standard normal draw (Box-Muller on the first two words of the block)
+inline float CounterRNG::normal(uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw) const
+{
+    array<uint32_t,4> x = block(stream, step, cell, draw);
+    float u1 = (float(x[0] >> 8) + 1.f) * (1.f / 16777216.f);   // (0,1] to avoid log(0)
+    float u2 = toUniform(x[1]);
+    return sqrt(-2.f * log(u1)) * cos(2.f * float(M_PI) * u2);
+}
+
+//Bernoulli draw of parameter p
+inline bool CounterRNG::bernoulli(float p, uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw) const
+{
+    return uniform(stream, step, cell, draw) < p;
+}
+
+//Uniform integer draw in [lo,hi]
+inline int CounterRNG::uniformInt(int lo, int hi, uint32_t stream, uint32_t step, uint32_t cell, uint32_t draw) const
+{
+    return toInt(block(stream, step, cell, draw)[0], lo, hi);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef DEF_RASTER_HPP
+#define DEF_RASTER_HPP
+
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Lightweight 8 bits RGBA image, used to build an environment from data images
+// without depending on a graphics library.
+//
+// The pixels are stored row after row, 4 values (red, green, blue, alpha) per pixel.
+// The rendering add-on (Display.hpp) reads the image files into rasters.
+//
+//======================================================================
+//                        Class Raster definition
+//======================================================================
+
+class Raster
+{
+public:
+    int width = 0;                  //Number of columns
+    int height = 0;                 //Number of rows
+    vector<uint8_t> pixels;         //RGBA values, row after row
+
+    //Constructors
+    Raster(){};
+    Raster(int w, int h) : width(w), height(h), pixels(4*w*h, 255) {};
+
+    //Member functions
+    uint8_t red(int x, int y) const {return pixels[4*(y*width+x)];}
+    void setPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255){
+        uint8_t* p = &pixels[4*(y*width+x)];
+        p[0] = r; p[1] = g; p[2] = b; p[3] = a;
+    }
+};
+
+#endif
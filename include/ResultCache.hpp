@@ -0,0 +1,54 @@
+#ifndef DEF_RESULTCACHE_HPP
+#define DEF_RESULTCACHE_HPP
+
+#include <string>
+#include <cstdint>
+#include "Environment.hpp"
+
+using namespace std;
+
+class Simulation;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// On-disk cache of the results of the Simulations (exploratory sweeps run again).
+//
+// The key of a run is a 64 bits hash (FNV-1a) of everything its result depends on :
+// size, conditions, scores, species (name, niche, speed, tolerance), repartition,
+// numbers of changes, rules of the automaton, neighbourhood, boundaries, random
+// stream (seed, replicate, step) and number of iterations. The engine is left out
+// (every engine gives the same result). Any change of an input gives another key,
+// so a stale result is never read back.
+//
+// A result is a file <key>.bin of the directory : time before stationarity, series
+// (counts, changes, interface length), final repartition, numbers of changes and
+// colonisation times. A Simulation given a cache (and no observer, which needs every
+// iteration) reads it instead of running. A run in which hybrids appeared is not
+// stored : its series do not match the species of the inputs.
+//
+//======================================================================
+//                      Class ResultCache definition
+//======================================================================
+
+class ResultCache
+{
+public:
+    string directory;                           //Directory of the result files
+    int hits = 0;                               //Runs read from the cache
+    int misses = 0;                             //Runs not found in the cache
+
+    //Constructors
+    ResultCache(string dir);
+
+    //Member functions
+    static uint64_t key(const Environment& env, int nIter);        //Hash of the inputs of a run
+    bool load(uint64_t key, Simulation& result);                    //Result of a run (false if not in the cache)
+    void store(uint64_t key, const Simulation& result, int inputSpecies) const;  //Save the result of a run (inputSpecies : number of species of the inputs)
+
+private:
+    string path(uint64_t key) const;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef DEF_SCORELAYER_HPP
+#define DEF_SCORELAYER_HPP
+
+#include <vector>
+#include <cstdint>
+#include "Vecteur.hpp"
+#include "Shared.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Adaptation scores of one species on the lattice (read-only, shared by the copies).
+//
+// The conditions of an environment built from images are a function of the pixel
+// values of the node (one byte per image), the ones of a percolation environment of the
+// draw of the node, so the score of a species only depends on the level of the node :
+// 256 levels for one image, 65536 for two, 2 for a percolation. The layer is then
+// a table of the scores of the levels and the levels of the nodes, shared by every
+// species : scoring the lattice is a gather and a species costs a small table instead
+// of a float per node. Other environments keep the score of every node.
+//
+// Compact storage (compact) : the score of every node is replaced by its rank in the
+// sorted list of the distinct scores of the layer, on 8 bits (up to 256 distinct
+// scores) or 16 bits (up to 65536), and the list is kept. The rank gives back the
+// exact score, so the winners of every selection are the ones of the float layer. A
+// table, or a layer with too many distinct scores to save memory, is left as it is.
+//
+// The definitions of the non-inline functions are in src/core/ScoreLayer.cpp.
+//
+//======================================================================
+//                      Class ScoreLayer definition
+//======================================================================
+
+class ScoreLayer
+{
+public:
+    //Constructors
+    ScoreLayer(){};
+    ScoreLayer(Vecteur<float> plane) : values(move(plane)) {point();};                                                //Score of each node
+    ScoreLayer(Vecteur<float> table, Shared<vector<uint16_t>> nodeLevels) : values(move(table)), levels(nodeLevels) {point();};  //Table of the levels
+
+    //Member functions
+    float operator[](int c) const {
+        if (level != nullptr){return value[level[c]];}
+        if (rank != nullptr){return value[rank[c]];}
+        return value[c];
+    }
+    int size() const {return (level != nullptr) ? levels.size() : (rank != nullptr) ? ranks.size() : values.size();}
+    bool isTable() const {return (level != nullptr) and !coded;}
+    long bytes() const;                                                     //Memory of the species (the levels are shared by every species)
+    ScoreLayer compact() const;                                             //Same scores, ranks on 8 or 16 bits (see Description)
+    Vecteur<float> plane() const {                                          //Score of each node
+        int mn = size();
+        Vecteur<float> grid(mn);
+        for (int c=0; c<mn; c++){grid[c] = (*this)[c];}
+        return grid;
+    }
+
+private:
+    Shared<Vecteur<float>> values;              //Score of each node, or of each level if the layer is a table
+    Shared<vector<uint16_t>> levels;            //Level (or rank on 16 bits) of each node
+    Shared<vector<uint8_t>> ranks;              //Rank on 8 bits of each node
+    bool coded = false;                         //Scores coded by their rank (values : distinct scores, levels or ranks : ranks)
+    const float* value = nullptr;               //Buffers of the shared layers (kept by values, levels and ranks, never written)
+    const uint16_t* level = nullptr;
+    const uint8_t* rank = nullptr;
+
+    void point(){
+        value = values->data();
+        level = (levels.size() != 0) ? levels->data() : nullptr;
+        rank = (ranks.size() != 0) ? ranks->data() : nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef DEF_SHARED_HPP
+#define DEF_SHARED_HPP
+
+#include <memory>
+#include <utility>
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Read-only buffer shared by reference counting (copy on write).
+//
+// The layers of an environment that do not change during a run (conditions, scores
+// of the species) are held in shared buffers : copying an Environment (every
+// iteration of a Simulation, every run of a sweep built on the same site) only
+// copies a pointer. The buffer is copied the first time it is written while shared
+// (write()), so an environment never sees the changes of another one.
+//
+//======================================================================
+//                        Class Shared definition
+//======================================================================
+
+template<typename T>
+class Shared
+{
+public:
+    //Constructors
+    Shared(){};
+    Shared(T value) : data(make_shared<T>(move(value))) {};
+
+    //Read access
+    const T& operator*() const {return (data != nullptr) ? *data : empty();}
+    const T* operator->() const {return &**this;}
+    operator const T&() const {return **this;}
+    template<typename I> auto operator[](const I& i) const -> decltype(declval<const T&>()[i]) {return (**this)[i];}
+    auto size() const {return (**this).size();}
+    auto begin() const {return (**this).begin();}
+    auto end() const {return (**this).end();}
+    long owners() const {return data.use_count();}          //Number of environments sharing the buffer
+
+    //Write access (copy of the buffer if it is shared)
+    T& write(){
+        if (data == nullptr){data = make_shared<T>();}
+        else if (data.use_count() > 1){data = make_shared<T>(*data);}
+        return *data;
+    }
+
+private:
+    shared_ptr<T> data;
+
+    static const T& empty(){static const T value; return value;}
+};
+
+#endif
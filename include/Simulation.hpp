@@ -8,14 +8,16 @@
 #include <cmath>
 #include <map>
 #include <string>
-#include <SFML/Graphics.hpp>
-#include <filesystem>
 #include "VariableEnv.hpp"
 #include "Population.hpp"
 #include "Environment.hpp"
-#include "Functor.hpp"
 #include "Vecteur.hpp"
-#include "Display.hpp"
+#include "Profiler.hpp"
+#include "Memory.hpp"
+#include "EventDriven.hpp"
+#include "TemporalBlocking.hpp"
+#include "DomainDecomposition.hpp"
+#include "ResultCache.hpp"
 
 
 using namespace std;
@@ -30,6 +32,39 @@ using namespace std;
 // before reaching stationnarity and each population number of sub-population 
 // at each time of the simulation.
 //
+// Engines (Environment::solver), all giving exactly the same result :
+//  - "auto"      : event driven (EventDriven.hpp) for a determinist run in a constant
+//                  environment, only updating the nodes that change; otherwise tiled
+//                  on a lattice larger than Environment::tiledThreshold, else iterative
+//  - "iterative" : migration then selection of the whole lattice at every iteration
+//  - "tiled"     : several iterations per cache-resident tile (TemporalBlocking.hpp),
+//                  one iteration per block when an observer is set
+// With Environment::processes > 1 (and a rule the tiles support) the run is shared by
+// several processes, each one owning a band of rows (DomainDecomposition.hpp). Runs
+// creating hybrids (Environment::hybridProbability) are iterative.
+//
+// The counts of the species (countVector) and the number of nodes that changed are
+// recorded at every iteration from the nodes that change, without scanning the lattice.
+// A hybrid gets its series at its first appearance (0 before).
+//
+// An optional observer is called with the initial environment and after every
+// iteration, to write images (ImageObserver of Display.hpp) or collect statistics
+// without coupling the stepping engine to the rendering.
+//
+// With an optional ResultCache (and no observer) a run already done with the same
+// inputs is read from the disk instead of being run again.
+//
+//======================================================================
+//                           Class StepObserver
+//======================================================================
+
+class StepObserver
+{
+    public :
+        virtual ~StepObserver(){};
+        virtual void operator()(const Environment& env, int step) = 0;      //Called at step 0 and after every iteration
+};
+
 //======================================================================
 //                           Class Simulation 
 //======================================================================
@@ -39,58 +74,17 @@ class Simulation
     public :
         Environment  environment;               //Final environnement
         Vecteur<Vecteur<float>> countVector;    //Each population number of sub-population at each time of the simulation
+        Vecteur<int> changedNodes;              //Number of nodes whose occupant changed at each time of the simulation (0 at start)
+        Vecteur<int> interfaceLength;           //Length of the interfaces at each time (if Environment::recordInterface, see Environment::interfaceLength)
         int timeBeforeStationarity;             //Number of interations needed before reaching stationnarity         
+        vector<int> colonisationTime;           //Iteration at which each node got its last occupant (0 at start, -1 if never occupied)
+#ifdef PROFILER_ENABLED
+        Profiler profiler;                      //Time spent in each phase of the run (make PROFILE=1 and/or MEMORY=1)
+#endif
+        vector<MemoryRecord> memoryTrace;       //Allocations, bytes and peak live bytes of each iteration (filled when compiled with -DMEMORY_TRACKING)
 
         //Constructor               
-        Simulation(const Environment& env_init, int nIter, bool plot); //Constructor
+        Simulation(const Environment& env_init, int nIter, StepObserver* observer = nullptr, ResultCache* cache = nullptr); //Constructor
 };
 
-//======================================================================
-//                           Member functions
-//======================================================================
-
-Simulation::Simulation(const Environment& env_init, int nIter, bool plot)
-{   
-    //Initialization
-    environment = env_init;
-    timeBeforeStationarity = 0;     
-    countVector.resize(environment.species.size());
-
-    //count the populations
-    Vecteur<float> counts = environment.countPopulations();
-    for (int k=0; k<environment.species.size(); k++){countVector[k].push_back(counts[k]);}
-    
-    //Dimensions to display in the environment
-    int dimension=0;
-
-    //Generate pixel array
-    if (plot==true){environment.display("merged", dimension);}
-
-    for (int i=1; i<nIter; i++)
-    {   
-        //Keep in memory the old environment
-        Environment oldEnvironment(environment);
-
-        //environment=selection(diffusion(environmentalChange(environment, i, a, b)));
-        environment=environment.migration().selection();
-
-        //Count the populations
-        //Vecteur<float> counts = environment.countPopulations();
-        //for (int k=0; k<environment.species.size(); k++){countVector[k].push_back(counts[k]);}
-
-        //Display settings
-        if (plot==true){environment.display("merged", dimension, i);}
-
-        //Check if the automaton is still avancing
-        if (oldEnvironment == environment & timeBeforeStationarity==0){timeBeforeStationarity=i-1; break;}
-    }
-}
-
-//======================================================================
-//                          External functions
-//======================================================================
-
-
-
-
-#endif
\ No newline at end of file
+#endif
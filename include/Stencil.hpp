@@ -0,0 +1,69 @@
+#ifndef DEF_STENCIL_HPP
+#define DEF_STENCIL_HPP
+
+#include <vector>
+#include <iostream>
+#include <string>
+#include <set>
+#include <utility>
+#include "Vecteur.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Define the neighbourhood stencils used during the migration.
+//
+// A stencil is the list of offsets (di,dj) reached by a species in one iteration.
+// It is computed once per distinct diffusion speed, without duplicated offsets.
+// The flat offsets (di*width+dj) index a lattice padded with a halo as wide as the
+// largest stencil, so the migration never checks bounds : the boundary conditions
+// are handled by mapping each halo node to a node of the lattice (or to nothing).
+//
+// Neighbourhoods :
+//  - "vonNeumann" : diamond |di|+|dj| <= speed (default, original rule)
+//  - "moore"      : square max(|di|,|dj|) <= speed
+//  - "custom"     : kernel given as a (2R+1)x(2R+1) matrix of 0/1 centered on the node,
+//                   used for a speed of 1 and dilated speed times for larger speeds
+//
+// Boundary conditions (per axis) :
+//  - "open"       : what leaves the lattice is lost (default, original rule)
+//  - "periodic"   : toroidal lattice
+//  - "reflective" : what leaves the lattice is mirrored back (x = -1 -> 0, x = -2 -> 1)
+//
+//======================================================================
+//                       Class Stencil definition
+//======================================================================
+
+class Stencil
+{
+public:
+    string shape;           //Neighbourhood : "vonNeumann", "moore", "custom"
+    int speed;              //Diffusion speed the stencil is made for
+    int radius;             //Largest |di| or |dj| of the stencil
+    vector<int> di;         //Row offsets
+    vector<int> dj;         //Column offsets
+    vector<int> flat;       //Offsets in the flattened padded lattice
+
+    //Constructors
+    Stencil(){};
+    Stencil(string neighbourhood, int diffusionSpeed, int width, const Vecteur<Vecteur<int>>& kernel = Vecteur<Vecteur<int>>());
+
+    //Member functions
+    int size() const {return di.size();}
+    void setWidth(int width);
+};
+
+//======================================================================
+//                         External functions
+//======================================================================
+
+//Index in [0,size) of the coordinate x according to the boundary condition (-1 if x is outside an open lattice)
+int boundaryIndex(int x, int size, const string& boundary);
+
+//Map of a lattice padded with a halo to the nodes of the m*n lattice (sink index m*n outside an open boundary)
+vector<int> haloMap(int m, int n, int rowHalo, int colHalo, const string& rowBoundary, const string& columnBoundary);
+
+#endif
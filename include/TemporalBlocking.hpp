@@ -0,0 +1,110 @@
+#ifndef DEF_TEMPORALBLOCKING_HPP
+#define DEF_TEMPORALBLOCKING_HPP
+
+#include <vector>
+#include <string>
+#include "Environment.hpp"
+#include "Vecteur.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Temporal blocking engine ("tiled" solver of a Simulation).
+//
+// An iteration streams the whole lattice through the memory twice (migration, then
+// selection, each building a new Environment). On a lattice much larger than the
+// caches, the engine instead cuts the lattice in square tiles and advances each tile
+// k iterations at once : the tile is loaded with a halo of k*R nodes (R the largest
+// stencil radius), then every iteration migrates and selects in the same pass on a
+// region shrinking by R nodes, so the k iterations run in cache and the tile is
+// written back once. The halo nodes are computed again by the neighbouring tiles.
+//
+// The state is one species index per node. The arrivals of a node are gathered in
+// the order of Environment::migration (sources in row-major order, the species using
+// the minimum filter included) and the random draws are keyed on the same (step, node)
+// as in the iterative run, so the result is exactly the same, stochastic rules included.
+//
+// The halo of a tile crossing a periodic or reflective boundary holds the images of
+// the nodes. With a reflective boundary this needs stencils symmetric along both axes
+// (see Environment::supportsTiles).
+//
+//======================================================================
+//                      Class TileKernel definition
+//======================================================================
+
+//Buffers of a tile and its halo (one set per thread, reused for every tile)
+struct TileWindow
+{
+    int rows = 0;                               //Rows of the tile and its halo
+    int columns = 0;                            //Columns of the tile and its halo
+    bool sortSources = false;                   //Images of the nodes in the halo (the sources are not in row-major order)
+    vector<int> node;                           //Node of each position (-1 outside an open boundary)
+    vector<int> occ;                            //Occupant of each position (index of the species, -1 if empty)
+    vector<int> chg;                            //Number of changes of each position
+    vector<int> last;                           //Iteration of the block at which each position changed last (0 if not)
+    vector<float> score;                        //Scores of the species on each position (index w*S+k)
+
+    //Work buffers
+    vector<int> newOcc, newChg, flat, candidates;
+    vector<pair<int,int>> arrivals;
+    vector<uint64_t> candidateMask;             //Species already candidates of the node (bitmask of the indices, 64 per word)
+    Vecteur<float> candidateScores;
+
+    void resize(int wm, int wn, int S);
+};
+
+//Migration and selection of a window, shared by the tiled engines (TemporalBlocking, DomainDecomposition, OutOfCore)
+class TileKernel
+{
+public:
+    int radius = 0;                             //Largest stencil radius
+    vector<int> di;                             //Row offsets reaching a node (union of the stencils, sources in row-major order)
+    vector<int> dj;                             //Column offsets reaching a node
+    vector<char> reaches;                       //True if the species k migrates along the offset u (index u*S+k)
+
+    //Constructors
+    TileKernel(){};
+    TileKernel(const Environment& env);
+
+    //Member functions
+    void advance(const Environment& env, int steps, TileWindow& w, int th, int tw, int* stepChanges, int* stepDeltas = nullptr) const;   //steps iterations of a window
+};
+
+//======================================================================
+//                   Class TemporalBlocking definition
+//======================================================================
+
+class TemporalBlocking
+{
+public:
+    int tileSize = 64;                          //Side of the tiles
+    vector<int> occupant;                       //Index of the species occupying each node (-1 if empty)
+    vector<int> changedAt;                      //Iteration of the last block at which each node changed (1 to k, 0 if not)
+    vector<int> changes;                        //Number of nodes that changed at each iteration of the last block
+    vector<int> deltas;                         //Number of nodes gained by each species at each iteration of the last block (index s*S+k)
+
+    //Constructors
+    TemporalBlocking(){};
+    TemporalBlocking(const Environment& env);
+
+    //Member functions
+    int advance(Environment& env, int steps);   //Up to steps iterations, stopping after the first one without change (returns the number done)
+    void writeBack(Environment& env) const;     //Repartition of the environment from the occupants
+    void advanceRows(const Environment& env, int steps, int rowBegin, int rowEnd, const int* occupantIn, const int* changesIn,
+                     int* occupantOut, int* changesOut, int* changedAtOut, int* stepChanges, int* stepDeltas) const;  //Rows of a process (DomainDecomposition)
+
+private:
+    TileKernel kernel;                          //Stencils of the species
+    vector<float> scores;                       //Adaptation score of each species on each node (species after species)
+    vector<int> nextOccupant;                   //Occupants after the block
+    vector<int> nextChanges;                    //Numbers of changes after the block
+
+    void block(const Environment& env, int steps, vector<int>& nextOccupant, vector<int>& nextChanges);
+    void tile(const Environment& env, int steps, int r0, int th, int c0, const int* occupantIn, const int* changesIn,
+              int* occupantOut, int* changesOut, int* changedAtOut, int* stepChanges, int* stepDeltas, TileWindow& w) const;
+};
+
+#endif
@@ -9,6 +9,8 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <functional>
+#include <type_traits>
 
 using namespace std;
 
@@ -20,30 +22,126 @@ using namespace std;
 // We define them using the class vector from C++ standard library.
 // we define extra operations.
 //
+// The arithmetic operators do not compute anything : they return an expression
+// (a small object holding its operands) which is evaluated when it is assigned to a
+// Vecteur (constructor, =, +=, -=). A compound expression such as u*u - 2.f*(u*v) + v*v
+// is then computed in one loop, component after component, without any temporary
+// vector. The operands are held by reference : an expression must be assigned to a
+// Vecteur in the statement where it is built (never kept with auto).
+//
+// SmallVecteur<T,N> has the same operators with at most N components stored in the
+// object itself (no allocation) : conditions of the nodes, niches and tolerances of
+// the species have a few components, and an array of them is one contiguous block.
+//
+//===========================================================================
+//                          Define expressions
+//===========================================================================
+
+template <typename E, typename T>
+class VecteurExpr
+{
+public:
+  using Scalar = T;                                                 // type des composantes
+  const E &self() const { return static_cast<const E &>(*this); }  // expression dérivée
+};
+
+template <typename T>
+class Vecteur;
+
+template <typename T, int N>
+class SmallVecteur;
+
+// Operands of the expressions : a Vecteur by reference, an expression by value
+template <typename E>
+struct VecteurOperand { using type = const E; };
+
+template <typename T>
+struct VecteurOperand<Vecteur<T>> { using type = const Vecteur<T> &; };
+
+template <typename T, int N>
+struct VecteurOperand<SmallVecteur<T, N>> { using type = const SmallVecteur<T, N> &; };
+
+inline void checkSameSize(int n, int p)
+{
+  if (n != p)
+  {
+    cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs";
+    exit(1);
+  }
+}
+
+// u op v (composante par composante)
+template <typename L, typename R, typename Op, typename T>
+class VecteurBinary : public VecteurExpr<VecteurBinary<L, R, Op, T>, T>
+{
+public:
+  VecteurBinary(const L &u, const R &v) : u(u), v(v) { checkSameSize(u.size(), v.size()); }
+  int size() const { return u.size(); }
+  T operator[](int i) const { return Op()(u[i], v[i]); }
+
+private:
+  typename VecteurOperand<L>::type u;
+  typename VecteurOperand<R>::type v;
+};
+
+// u op x
+template <typename L, typename Op, typename T>
+class VecteurScalar : public VecteurExpr<VecteurScalar<L, Op, T>, T>
+{
+public:
+  VecteurScalar(const L &u, const T &x) : u(u), x(x) {}
+  int size() const { return u.size(); }
+  T operator[](int i) const { return Op()(u[i], x); }
+
+private:
+  typename VecteurOperand<L>::type u;
+  T x;
+};
+
+// -u
+template <typename L, typename T>
+class VecteurNegate : public VecteurExpr<VecteurNegate<L, T>, T>
+{
+public:
+  VecteurNegate(const L &u) : u(u) {}
+  int size() const { return u.size(); }
+  T operator[](int i) const { return -u[i]; }
+
+private:
+  typename VecteurOperand<L>::type u;
+};
+
 //===========================================================================
 //                          Define vector class
 //===========================================================================
 
 template <typename T>
-class Vecteur : public vector<T>
+class Vecteur : public vector<T>, public VecteurExpr<Vecteur<T>, T>
 {
 public:
 
   // Constructeur
   Vecteur(int d = 0, const T &v0 = T()) : vector<T>(d, v0) {} // dim et composantes constantes
   Vecteur(const initializer_list<T> &vs) : vector<T>(vs) {}   // depuis une liste explicite
+  template <typename E>
+  Vecteur(const VecteurExpr<E, T> &e);                        // évaluation d'une expression
 
   // Fonctions membres
   T operator()(int i) const; // valeur    1->dim (indice non testé)
   T &operator()(int i);      // référence 1->dim (indice non testé)
 
-  Vecteur<T> &operator+=(const Vecteur<T> &v); // u += v
-  Vecteur<T> &operator-=(const Vecteur<T> &v); // u -= v
+  template <typename E>
+  Vecteur<T> &operator=(const VecteurExpr<E, T> &e);  // u = expression
+  template <typename E>
+  Vecteur<T> &operator+=(const VecteurExpr<E, T> &v); // u += v
+  template <typename E>
+  Vecteur<T> &operator-=(const VecteurExpr<E, T> &v); // u -= v
   Vecteur<T> &operator+=(const T &x);          // u += x
   Vecteur<T> &operator-=(const T &x);          // u -= x
   Vecteur<T> &operator*=(const T &x);          // u *= x
   Vecteur<T> &operator/=(const T &x);          // u /= x
-  float operator|(const Vecteur<T> &v) const;      // u|v
+  template <typename E>
+  float operator|(const VecteurExpr<E, T> &v) const;  // u|v
   float norm() const {return (*this)|(*this);};
 };  // fin de définition de la classe
 
@@ -51,6 +149,19 @@ public:
 //                          Fonctions membres
 //===========================================================================
 
+template<typename T>
+template<typename E>
+Vecteur<T>::Vecteur(const VecteurExpr<E, T> &e) : vector<T>(e.self().size())
+{
+  const E &x = e.self();
+  int n = (*this).size();
+
+  for (int i = 0; i < n; i++)
+  {
+    (*this)[i] = x[i];
+  }
+}
+
 template<typename T>
 T Vecteur<T>::operator()(int i) const {return this->at(i-1);}
 
@@ -58,35 +169,46 @@ template<typename T>
 T& Vecteur<T>::operator()(int i) {return this->at(i-1);}
 
 template<typename T>
-Vecteur<T>& Vecteur<T>::operator+=(const Vecteur<T> &v)
+template<typename E>
+Vecteur<T>& Vecteur<T>::operator=(const VecteurExpr<E, T> &e)
 {
-  int n = (*this).size();
-  if (n != v.size())
-  {
-    cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs";
-    exit(1);
-  }
+  const E &x = e.self();
+  int n = x.size();
+  (*this).resize(n);   // même taille si l'expression contient u : pas de réallocation
 
   for (int i = 0; i < n; i++)
   {
-    (*this)[i] += v[i];
+    (*this)[i] = x[i];
   }
   return *this;
 }
 
 template<typename T>
-Vecteur<T>& Vecteur<T>::operator-=(const Vecteur<T> &v)
+template<typename E>
+Vecteur<T>& Vecteur<T>::operator+=(const VecteurExpr<E, T> &v)
 {
+  const E &x = v.self();
   int n = (*this).size();
-  if (n != v.size())
+  checkSameSize(n, x.size());
+
+  for (int i = 0; i < n; i++)
   {
-    cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs";
-    exit(1);
+    (*this)[i] += x[i];
   }
+  return *this;
+}
+
+template<typename T>
+template<typename E>
+Vecteur<T>& Vecteur<T>::operator-=(const VecteurExpr<E, T> &v)
+{
+  const E &x = v.self();
+  int n = (*this).size();
+  checkSameSize(n, x.size());
 
   for (int i = 0; i < n; i++)
   {
-    (*this)[i] -= v[i];
+    (*this)[i] -= x[i];
   }
   return *this;
 }
@@ -95,9 +217,11 @@ template<typename T>
 Vecteur<T>& Vecteur<T>::operator+=(const T &x)
 {
   int n = (*this).size();
-  Vecteur<T> a(n, x);
 
-  (*this) += a;
+  for (int i = 0; i < n; i++)
+  {
+    (*this)[i] += x;
+  }
 
   return *this;
 }
@@ -106,9 +230,11 @@ template<typename T>
 Vecteur<T>& Vecteur<T>::operator-=(const T &x)
 {
   int n = (*this).size();
-  Vecteur<T> a(n, x);
 
-  (*this) -= a;
+  for (int i = 0; i < n; i++)
+  {
+    (*this)[i] -= x;
+  }
 
   return *this;
 }
@@ -139,11 +265,14 @@ Vecteur<T>& Vecteur<T>::operator/=(const T &x)
   return *this;
 } 
 
+
 template<typename T>
-float Vecteur<T>::operator|(const Vecteur<T> &v) const
+template<typename E>
+float Vecteur<T>::operator|(const VecteurExpr<E, T> &v) const
 {
+  const E &x = v.self();
   int n = (*this).size();
-  if (n != v.size())
+  if (n != x.size())
   {
     cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs (produit scalaire)";
     exit(1);
@@ -152,150 +281,239 @@ float Vecteur<T>::operator|(const Vecteur<T> &v) const
   T valeur = T();
   for (int i = 0; i < n; i++)
   {
-    valeur += (*this)[i] * v[i];
+    valeur += (*this)[i] * x[i];
   }
   return valeur;
 }
 
 //===========================================================================
-//                          Fonctions externes
+//                          Define small vector class
 //===========================================================================
 
-template <typename T>
-ostream &operator<<(ostream &out, const vector<T> &v)
+template <typename T, int N>
+class SmallVecteur : public VecteurExpr<SmallVecteur<T, N>, T>
 {
-  out << "[";
-  for (int i = 0; i < v.size(); i++)
+public:
+
+  // Constructeur
+  SmallVecteur(int d = 0, const T &v0 = T()) { resize(d, v0); }       // dim et composantes constantes
+  SmallVecteur(const initializer_list<T> &vs);                         // depuis une liste explicite
+  template <typename E>
+  SmallVecteur(const VecteurExpr<E, T> &e) { (*this) = e; }           // évaluation d'une expression (ou d'un Vecteur)
+
+  // Accès
+  int size() const { return length; }
+  bool empty() const { return length == 0; }
+  const T &operator[](int i) const { return values[i]; }
+  T &operator[](int i) { return values[i]; }
+  T operator()(int i) const { return values[i-1]; } // valeur    1->dim (indice non testé)
+  T &operator()(int i) { return values[i-1]; }      // référence 1->dim (indice non testé)
+  const T *data() const { return values; }
+  T *data() { return values; }
+  const T *begin() const { return values; }
+  const T *end() const { return values + length; }
+  T *begin() { return values; }
+  T *end() { return values + length; }
+
+  // Fonctions membres
+  void resize(int d, const T &v0 = T());
+  void push_back(const T &x) { resize(length + 1, x); }
+  void clear() { length = 0; }
+
+  template <typename E>
+  SmallVecteur<T, N> &operator=(const VecteurExpr<E, T> &e);  // u = expression
+  template <typename E>
+  SmallVecteur<T, N> &operator+=(const VecteurExpr<E, T> &v); // u += v
+  template <typename E>
+  SmallVecteur<T, N> &operator-=(const VecteurExpr<E, T> &v); // u -= v
+  SmallVecteur<T, N> &operator+=(const T &x) { for (int i = 0; i < length; i++) { values[i] += x; } return *this; } // u += x
+  SmallVecteur<T, N> &operator-=(const T &x) { for (int i = 0; i < length; i++) { values[i] -= x; } return *this; } // u -= x
+  SmallVecteur<T, N> &operator*=(const T &x) { for (int i = 0; i < length; i++) { values[i] *= x; } return *this; } // u *= x
+  SmallVecteur<T, N> &operator/=(const T &x) { for (int i = 0; i < length; i++) { values[i] /= x; } return *this; } // u /= x
+  template <typename E>
+  float operator|(const VecteurExpr<E, T> &v) const;  // u|v
+  float norm() const {return (*this)|(*this);};
+
+  bool operator==(const SmallVecteur<T, N> &v) const { return equal(begin(), end(), v.begin(), v.end()); }
+  bool operator!=(const SmallVecteur<T, N> &v) const { return !((*this) == v); }
+
+private:
+  T values[N] = {};     // composantes (les length premières)
+  int length = 0;       // dimension
+};  // fin de définition de la classe
+
+//===========================================================================
+//                          Fonctions membres
+//===========================================================================
+
+template<typename T, int N>
+SmallVecteur<T, N>::SmallVecteur(const initializer_list<T> &vs)
+{
+  for (const T &x : vs)
   {
-    if (i != 0)
-    {
-      out << ",";
-    }
-    out << v[i];
+    push_back(x);
   }
-  out << "]";
-  return (out);
-};
+}
 
-template <typename T>
-Vecteur<T> operator+(const Vecteur<T> &u, const Vecteur<T> &v)
+template<typename T, int N>
+void SmallVecteur<T, N>::resize(int d, const T &v0)
 {
-  int n = u.size();
-  if (n != v.size())
+  if (d > N)
   {
-    cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs";
+    cout << "hop hop hop trop de composantes pour ce petit vecteur (" << d << " > " << N << ")\n";
     exit(1);
   }
 
-  Vecteur<T> nouveau(n);
+  for (int i = length; i < d; i++)
+  {
+    values[i] = v0;
+  }
+  length = d;
+}
+
+template<typename T, int N>
+template<typename E>
+SmallVecteur<T, N>& SmallVecteur<T, N>::operator=(const VecteurExpr<E, T> &e)
+{
+  const E &x = e.self();
+  int n = x.size();
+  resize(n);   // composantes en place : l'expression peut contenir u
 
   for (int i = 0; i < n; i++)
   {
-    nouveau[i] = u[i] + v[i];
+    values[i] = x[i];
   }
-  return nouveau;
-} // u + v
+  return *this;
+}
 
-template <typename T>
-Vecteur<T> operator-(const Vecteur<T> &u, const Vecteur<T> &v)
+template<typename T, int N>
+template<typename E>
+SmallVecteur<T, N>& SmallVecteur<T, N>::operator+=(const VecteurExpr<E, T> &v)
 {
-  return (u + (-v));
-} // u - v
+  const E &x = v.self();
+  checkSameSize(length, x.size());
 
-template <typename T>
-Vecteur<T> operator+(const Vecteur<T> &u) { return u; } // +u
+  for (int i = 0; i < length; i++)
+  {
+    values[i] += x[i];
+  }
+  return *this;
+}
 
-template <typename T>
-Vecteur<T> operator-(const Vecteur<T> &u)
+template<typename T, int N>
+template<typename E>
+SmallVecteur<T, N>& SmallVecteur<T, N>::operator-=(const VecteurExpr<E, T> &v)
 {
-  int n = u.size();
-  Vecteur<T> nouveau(n);
+  const E &x = v.self();
+  checkSameSize(length, x.size());
 
-  for (int i = 0; i < n; i++)
+  for (int i = 0; i < length; i++)
   {
-    nouveau[i] = -u[i];
+    values[i] -= x[i];
   }
-  return nouveau;
-} // +u
+  return *this;
+}
 
-template <typename T>
-Vecteur<T> operator+(const Vecteur<T> &u, const T &x)
+template<typename T, int N>
+template<typename E>
+float SmallVecteur<T, N>::operator|(const VecteurExpr<E, T> &v) const
 {
-  int n = u.size();
-  Vecteur<T> nouveau(n);
-  Vecteur<T> x_vector(n, x);
+  const E &x = v.self();
+  if (length != x.size())
+  {
+    cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs (produit scalaire)";
+    exit(1);
+  }
 
-  nouveau = u + x_vector;
-  return nouveau;
-} // u + x
+  T valeur = T();
+  for (int i = 0; i < length; i++)
+  {
+    valeur += values[i] * x[i];
+  }
+  return valeur;
+}
 
-template <typename T>
-Vecteur<T> operator-(const Vecteur<T> &u, const T &x) { return u + (-x); } // u - x
+//===========================================================================
+//                          Fonctions externes
+//===========================================================================
 
 template <typename T>
-Vecteur<T> operator*(const Vecteur<T> &u, const T &x)
+ostream &operator<<(ostream &out, const vector<T> &v)
 {
-  int n = u.size();
-  Vecteur<T> nouveau(n);
-
-  for (int i = 0; i < n; i++)
+  out << "[";
+  for (int i = 0; i < int(v.size()); i++)
   {
-    nouveau[i] = u[i] * x;
+    if (i != 0)
+    {
+      out << ",";
+    }
+    out << v[i];
   }
-  return nouveau;
-} // u * x
+  out << "]";
+  return (out);
+};
 
-template <typename T>
-Vecteur<T> operator*(const T &x, const Vecteur<T> &u) { return u * x; } // x*u
+template <typename E, typename T, typename = enable_if_t<!is_base_of<vector<T>, E>::value>>
+ostream &operator<<(ostream &out, const VecteurExpr<E, T> &e) { return out << Vecteur<T>(e); } // expression
 
-template <typename T>
-Vecteur<T> operator/(const Vecteur<T> &u, const T &x)
+template <typename L, typename R, typename T>
+VecteurBinary<L, R, plus<>, T> operator+(const VecteurExpr<L, T> &u, const VecteurExpr<R, T> &v)
 {
-  int n = u.size();
-  Vecteur<T> nouveau(n);
+  return VecteurBinary<L, R, plus<>, T>(u.self(), v.self());
+} // u + v
 
-  for (int i = 0; i < n; i++)
-  {
-    nouveau[i] = u[i] / x;
-  }
-  return nouveau;
-} // u / x
+template <typename L, typename R, typename T>
+VecteurBinary<L, R, minus<>, T> operator-(const VecteurExpr<L, T> &u, const VecteurExpr<R, T> &v)
+{
+  return VecteurBinary<L, R, minus<>, T>(u.self(), v.self());
+} // u - v
 
-template<typename T>
-Vecteur<T> operator*(const Vecteur<T> &u, const Vecteur<T> &v)
+template <typename L, typename T>
+const L &operator+(const VecteurExpr<L, T> &u) { return u.self(); } // +u
+
+template <typename L, typename T>
+VecteurNegate<L, T> operator-(const VecteurExpr<L, T> &u)
 {
-  int n = u.size();
-  Vecteur<T> nouveau(n);
+  return VecteurNegate<L, T>(u.self());
+} // -u
 
-  if (n != v.size())
-  {
-    cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs";
-    exit(1);
-  }
+template <typename L, typename T>
+VecteurScalar<L, plus<>, T> operator+(const VecteurExpr<L, T> &u, const typename VecteurExpr<L, T>::Scalar &x)
+{
+  return VecteurScalar<L, plus<>, T>(u.self(), x);
+} // u + x
 
-  for (int i = 0; i < n; i++)
-  {
-    nouveau[i] = u[i] * v[i];
-  }
-  return nouveau;
-}
+template <typename L, typename T>
+VecteurScalar<L, minus<>, T> operator-(const VecteurExpr<L, T> &u, const typename VecteurExpr<L, T>::Scalar &x)
+{
+  return VecteurScalar<L, minus<>, T>(u.self(), x);
+} // u - x
 
-template<typename T>
-Vecteur<T> operator/(const Vecteur<T> &u, const Vecteur<T> &v)
+template <typename L, typename T>
+VecteurScalar<L, multiplies<>, T> operator*(const VecteurExpr<L, T> &u, const typename VecteurExpr<L, T>::Scalar &x)
 {
-  int n = u.size();
-  Vecteur<T> nouveau(n);
+  return VecteurScalar<L, multiplies<>, T>(u.self(), x);
+} // u * x
 
-  if (n != v.size())
-  {
-    cout << "hop hop hop ils n'ont pas la meme taille tes vecteurs";
-    exit(1);
-  }
+template <typename L, typename T>
+VecteurScalar<L, multiplies<>, T> operator*(const typename VecteurExpr<L, T>::Scalar &x, const VecteurExpr<L, T> &u) { return u * x; } // x*u
 
-  for (int i = 0; i < n; i++)
-  {
-    nouveau[i] = u[i] / v[i];
-  }
-  return nouveau;
-}
-#endif
\ No newline at end of file
+template <typename L, typename T>
+VecteurScalar<L, divides<>, T> operator/(const VecteurExpr<L, T> &u, const typename VecteurExpr<L, T>::Scalar &x)
+{
+  return VecteurScalar<L, divides<>, T>(u.self(), x);
+} // u / x
+
+template <typename L, typename R, typename T>
+VecteurBinary<L, R, multiplies<>, T> operator*(const VecteurExpr<L, T> &u, const VecteurExpr<R, T> &v)
+{
+  return VecteurBinary<L, R, multiplies<>, T>(u.self(), v.self());
+} // u * v (composante par composante)
+
+template <typename L, typename R, typename T>
+VecteurBinary<L, R, divides<>, T> operator/(const VecteurExpr<L, T> &u, const VecteurExpr<R, T> &v)
+{
+  return VecteurBinary<L, R, divides<>, T>(u.self(), v.self());
+} // u / v (composante par composante)
+
+#endif
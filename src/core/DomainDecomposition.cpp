@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <csignal>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "DomainDecomposition.hpp"
+#include "Profiler.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+//Share the lattice and fork the processes of rank 1 to nProcesses-1, which run their iterations until
+//the same stationarity decision (or nIter) as the Simulation and exit
+void DomainDecomposition::start(const Environment& env, int nProcesses, int nIter, const vector<int>& colonisationTime)
+{
+    engine = TemporalBlocking(env);
+    engine.tileSize = env.tileSize;
+    mn = env.m*env.n;
+    S = env.species.size();
+    processes = max(1, min(nProcesses, env.m));
+    counts.assign(S, 0);
+    for (int k : engine.occupant){
+        if (k >= 0){counts[k] += 1;}
+    }
+    changedAt.assign(mn, 0);
+
+    //Bands of rows
+    firstRow.resize(processes+1);
+    for (int r=0; r<=processes; r++){firstRow[r] = (long(r)*env.m)/processes;}
+
+    //Shared mapping : barrier, then the arrays
+    size_t header = (sizeof(ProcessBarrier)+63)/64*64;
+    size_t ints = 5*size_t(mn) + 2*processes + 2*processes*S;
+    sharedBytes = header + ints*sizeof(int);
+    shared = mmap(nullptr, sharedBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED){cout << "no shared memory for the processes \n"; exit(1);}
+
+    barrier = new (shared) ProcessBarrier();
+    barrier->arrived = 0;
+    barrier->generation = 0;
+
+    int* data = (int*)((char*)shared + header);
+    occupant[0] = data;
+    occupant[1] = data+mn;
+    numberOfChanges[0] = data+2*mn;
+    numberOfChanges[1] = data+3*mn;
+    colonisation = data+4*mn;
+    stepChanges = data+5*mn;
+    stepDeltas = stepChanges+2*processes;
+
+    copy(engine.occupant.begin(), engine.occupant.end(), occupant[0]);
+    copy(env.numberOfChanges.begin(), env.numberOfChanges.end(), numberOfChanges[0]);
+    copy(colonisationTime.begin(), colonisationTime.end(), colonisation);
+    current = 0;
+
+    //Other processes : same iterations as the Simulation loop, on their own copy of the environment
+    parent = getpid();
+    for (int r=1; r<processes; r++){
+        pid_t pid = fork();
+        if (pid < 0){cout << "cannot fork the process " << r << "\n"; exit(1);}
+        if (pid == 0){
+            rank = r;
+            Environment local(env);
+            for (int i=1; i<nIter; i++){
+                int changes = step(local, i);
+                local.step += 1;
+                if (changes==0){break;}
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+}
+
+//One iteration of the rows of this process, then the reductions over the processes
+int DomainDecomposition::step(const Environment& env, int iteration)
+{
+    int in = current;
+    int out = 1-current;
+    int slot = iteration%2;
+    int begin = firstRow[rank];
+    int end = firstRow[rank+1];
+
+    //Own rows, the halo rows are read from the shared lattice
+    int changes = 0;
+    int* ownDeltas = stepDeltas + (slot*processes+rank)*S;
+    engine.advanceRows(env, 1, begin, end, occupant[in], numberOfChanges[in], occupant[out], numberOfChanges[out], changedAt.data(), &changes, ownDeltas);
+
+    for (int c=begin*env.n; c<end*env.n; c++){
+        if (changedAt[c] > 0){colonisation[c] = iteration;}
+    }
+    stepChanges[slot*processes+rank] = changes;
+
+    wait();
+
+    //Reductions (the slots of this iteration are only written again two iterations later, after the next barrier)
+    int total = 0;
+    for (int r=0; r<processes; r++){
+        total += stepChanges[slot*processes+r];
+        for (int k=0; k<S; k++){counts[k] += stepDeltas[(slot*processes+r)*S+k];}
+    }
+    current = out;
+    return total;
+}
+
+//Barrier of the processes : the last process to arrive opens it. The others spin, then sleep between the
+//checks of the processes (a process that died never arrives).
+void DomainDecomposition::wait()
+{
+    int generation = barrier->generation.load();
+    if (barrier->arrived.fetch_add(1)+1 == processes){
+        barrier->arrived.store(0);
+        barrier->generation.fetch_add(1);
+        return;
+    }
+    for (int spin=0; barrier->generation.load()==generation; spin++){
+        if (spin < 4096){sched_yield(); continue;}
+        checkProcesses();
+        usleep(50);
+    }
+}
+
+//Rank 0 : stop the run if a process it forked has ended (the processes only end after the last barrier).
+//Other ranks : end if rank 0 has ended (the process is then adopted by another one).
+void DomainDecomposition::checkProcesses()
+{
+    if (rank != 0){
+        if (getppid() != parent){_exit(1);}
+        return;
+    }
+    for (pid_t pid : children){
+        int status = 0;
+        if (waitpid(pid, &status, WNOHANG) != pid){continue;}
+        for (pid_t other : children){
+            if (other != pid){kill(other, SIGKILL); waitpid(other, &status, 0);}
+        }
+        munmap(shared, sharedBytes);
+        cout << "a process of the simulation failed \n";
+        exit(1);
+    }
+}
+
+//One iteration of every process, called by the Simulation (rank 0)
+int DomainDecomposition::advance(Environment& env, int iteration)
+{
+    PROFILE_PHASE(TILED_PHASE);
+    int changes = step(env, iteration);
+    env.step += 1;
+    return changes;
+}
+
+//Repartition of the environment from the shared occupants
+void DomainDecomposition::writeBack(Environment& env) const
+{
+    for (int c=0; c<mn; c++){
+        int k = occupant[current][c];
+        if (k < 0){env.repartition[c].clear();}
+        else if ((env.repartition[c].size()!=1) or (env.repartition[c][0]!=env.species[k].id)){
+            env.repartition[c] = vector<int>({env.species[k].id});
+        }
+    }
+}
+
+//Wait for the other processes, then copy the results and release the shared mapping
+void DomainDecomposition::finish(Environment& env, vector<int>& colonisationTime)
+{
+    for (pid_t pid : children){
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) or (WEXITSTATUS(status)!=0)){cout << "a process of the simulation failed \n"; exit(1);}
+    }
+    children.clear();
+
+    writeBack(env);
+    copy(numberOfChanges[current], numberOfChanges[current]+mn, env.numberOfChanges.begin());
+    copy(colonisation, colonisation+mn, colonisationTime.begin());
+
+    munmap(shared, sharedBytes);
+    shared = nullptr;
+}
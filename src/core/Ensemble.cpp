@@ -0,0 +1,174 @@
+#include <algorithm>
+#include "Ensemble.hpp"
+#include "Profiler.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+Ensemble::Ensemble(const vector<Environment>& envs, int nIter)
+{
+    if (envs.size()==0){cout << "empty ensemble \n"; exit(1);}
+    const Environment& E = envs[0];
+    m = E.m;
+    n = E.n;
+    replicates = envs.size();
+    species = E.species;
+    S = species.size();
+
+    //Every replicate runs the same determinist rule in a constant environment
+    for (const Environment& env : envs){
+        bool same = (env.m==m) and (env.n==n) and (int(env.species.size())==S) and (env.neighbourhood==E.neighbourhood)
+                    and (env.rowBoundary==E.rowBoundary) and (env.columnBoundary==E.columnBoundary);
+        for (int k=0; same and (k<S); k++){
+            same = (env.species[k]==species[k]) and (env.species[k].diffusion_speed==species[k].diffusion_speed)
+                   and (env.adaptationScores.count(species[k].name)!=0) and (env.stencils.count(species[k].diffusion_speed)!=0);
+        }
+        for (int c=0; same and (c<m*n); c++){
+            same = (env.repartition[c].size()==0) or ((env.repartition[c].size()==1) and (env.speciesIndex(env.repartition[c][0]) >= 0));
+        }
+        if (!same or (env.envType!="constant") or (env.migrationType!="determinist") or (env.selectionType!="determinist") or (env.hybridProbability > 0)){
+            cout << "the replicates of an ensemble need the same determinist rule in a constant environment \n";
+            exit(1);
+        }
+    }
+
+    timeBeforeStationarity.assign(replicates, 0);
+    counts.assign(replicates, Vecteur<float>(S, 0));
+    int batches = (replicates+63)/64;
+    occupant.assign(batches*S*m*n, 0);
+    for (int b=0; b<batches; b++){run(envs, b, nIter);}
+}
+
+//Simulation of the replicates 64*batch to 64*batch+63
+void Ensemble::run(const vector<Environment>& envs, int batch, int nIter)
+{
+    const Environment& E = envs[0];
+    int mn = m*n;
+    int first = 64*batch;
+    int lanes = min(64, replicates-first);
+    uint64_t laneMask = (lanes==64) ? ~uint64_t(0) : ((uint64_t(1) << lanes)-1);
+
+    //Occupancy and score comparisons of the replicates
+    uint64_t* occ = &occupant[batch*S*mn];
+    vector<uint64_t> better(S*S*mn, 0);
+    for (int r=0; r<lanes; r++){
+        const Environment& env = envs[first+r];
+        uint64_t bit = uint64_t(1) << r;
+        vector<const ScoreLayer*> scores;
+        for (int k=0; k<S; k++){scores.push_back(&env.adaptationScores.at(species[k].name));}
+        for (int c=0; c<mn; c++){
+            if (env.repartition[c].size()!=0){
+                int k = env.speciesIndex(env.repartition[c][0]);     //Same list as species
+                occ[k*mn+c] |= bit;
+            }
+            for (int k=0; k<S; k++){
+                for (int l=0; l<S; l++){
+                    if ((*scores[k])[c] > (*scores[l])[c]){better[(k*S+l)*mn+c] |= bit;}
+                }
+            }
+        }
+    }
+
+    //Padded lattice (see Environment::migration), the sink node m*n collects what leaves an open boundary
+    int width = n+2*E.halo;
+    vector<int> fold = haloMap(m, n, E.halo, E.halo, E.rowBoundary, E.columnBoundary);
+    vector<const Stencil*> stencils;
+    for (int k=0; k<S; k++){stencils.push_back(&E.stencils.at(species[k].diffusion_speed));}
+
+    //Candidates of each node : seen(k) if k is a candidate, before(k,l) if k is a candidate before l
+    vector<uint64_t> seen(S*(mn+1));
+    vector<uint64_t> before(S*S*(mn+1));
+    vector<uint64_t> next(S*mn);
+    auto arrive = [&](int target, int k, uint64_t lanesArriving){
+        uint64_t fresh = lanesArriving & ~seen[k*(mn+1)+target];
+        if (fresh==0){return;}
+        for (int l=0; l<S; l++){
+            if (l!=k){before[(k*S+l)*(mn+1)+target] |= fresh & ~seen[l*(mn+1)+target];}
+        }
+        seen[k*(mn+1)+target] |= fresh;
+    };
+
+    uint64_t done = 0;
+    for (int i=1; (i<nIter) and ((done & laneMask)!=laneMask); i++){
+        {
+            PROFILE_PHASE(MIGRATION_PHASE);
+
+            //The occupant is the first candidate
+            fill(before.begin(), before.end(), 0);
+            for (int k=0; k<S; k++){
+                copy(occ+k*mn, occ+(k+1)*mn, seen.begin()+k*(mn+1));
+                seen[k*(mn+1)+mn] = 0;
+                for (int l=0; l<S; l++){
+                    if (l!=k){copy(occ+k*mn, occ+(k+1)*mn, before.begin()+(k*S+l)*(mn+1));}
+                }
+            }
+
+            //Arrivals from the sources in row-major order (the species using the minimum filter have the same reach and order)
+            for (int source=0; source<mn; source++){
+                int padded = (source/n+E.halo)*width + source%n+E.halo;
+                for (int k=0; k<S; k++){
+                    uint64_t lanesSource = occ[k*mn+source];
+                    if (lanesSource==0){continue;}
+                    const Stencil& st = *stencils[k];
+                    for (int o=0; o<st.size(); o++){
+                        arrive(fold[padded+st.flat[o]], k, lanesSource);
+                    }
+                }
+            }
+        }
+
+        //Selection : k wins if no other candidate scores more, nor the same while being before k
+        uint64_t changed = 0;
+        {
+            PROFILE_PHASE(SELECTION_PHASE);
+            for (int c=0; c<mn; c++){
+                for (int k=0; k<S; k++){
+                    uint64_t wins = seen[k*(mn+1)+c];
+                    for (int l=0; (l<S) and (wins!=0); l++){
+                        if (l==k){continue;}
+                        uint64_t kBetter = better[(k*S+l)*mn+c];
+                        uint64_t lBetter = better[(l*S+k)*mn+c];
+                        wins &= ~seen[l*(mn+1)+c] | kBetter | (~lBetter & before[(k*S+l)*(mn+1)+c]);
+                    }
+                    next[k*mn+c] = wins;
+                    changed |= wins ^ occ[k*mn+c];
+                }
+            }
+            copy(next.begin(), next.end(), occ);
+        }
+
+        //Replicates without change are stationary (a determinist run stays still afterwards)
+        uint64_t stationary = ~changed & ~done & laneMask;
+        for (int r=0; r<lanes; r++){
+            if ((stationary >> r) & 1){timeBeforeStationarity[first+r] = i-1;}
+        }
+        done |= stationary;
+    }
+
+    //Final counts
+    for (int k=0; k<S; k++){
+        for (int c=0; c<mn; c++){
+            uint64_t w = occ[k*mn+c];
+            while (w != 0){
+                counts[first+__builtin_ctzll(w)][k] += 1;
+                w &= w-1;
+            }
+        }
+    }
+}
+
+//Final repartition of a replicate
+void Ensemble::writeBack(Environment& env, int replicate) const
+{
+    const uint64_t* occ = &occupant[(replicate/64)*S*m*n];
+    uint64_t bit = uint64_t(1) << (replicate%64);
+    for (int c=0; c<m*n; c++){
+        env.repartition[c].clear();
+        for (int k=0; k<S; k++){
+            if (occ[k*m*n+c] & bit){env.repartition[c].push_back(species[k].id); break;}
+        }
+    }
+}
@@ -0,0 +1,681 @@
+#include "Environment.hpp"
+#include "Functor.hpp"
+#include "Profiler.hpp"
+
+using namespace std;
+
+//======================================================================
+//External functions/operators
+//======================================================================
+
+//Print an envrionment in the terminal(repartition and conditions)
+ostream& operator <<(ostream & out, const Environment& E)
+{   
+    for(int i=0; i<E.n; i++)
+        {
+            out << "[";
+            for (int j=0; j<E.n; j++)
+            {
+                if (E.repartition[i*E.n+j].size()!=0) {out << E.population(E.repartition[i*E.n+j][0]).name << " ";}
+                else {out << "  ";}
+            }
+            out << "]";
+            for (int j=0; j<E.n; j++)
+            {
+                out << E.conditionsAt(i*E.n+j) << " ";
+            }
+            out << endl;
+        }
+    return out;
+}
+
+//make a customed name for the environment with its parameters
+string makeName(string filename, map<string,float> parameters, vector<Population> sp){
+    
+    //Add the parameters to the filename
+    for (auto it=parameters.begin(); it!=parameters.end(); ++it){
+        std::ostringstream value; value << std::fixed << std::setprecision(1) << it->second;
+        filename += it->first + "=" + value.str() + "\n ";
+    }
+
+    for (int i = 0; i < int(sp.size()); i++) {
+        std::ostringstream niche_stream; 
+        for (int j=0; j<sp[i].niche.parameters.size(); j++){
+            niche_stream << std::fixed << std::setprecision(1) << sp[i].niche.parameters[j];
+            if (j!=sp[i].niche.parameters.size()-1){niche_stream<<",";}
+        }
+        filename += sp[i].name + ":[{" + niche_stream.str() + "}," + to_string(sp[i].diffusion_speed) + "]";
+        if (i<int(sp.size())-1){filename += "_";} else {filename+="\n ";}
+    }
+    
+    return(filename);
+}
+
+
+//======================================================================
+// Member functions
+//======================================================================
+
+//float unitEnv, int m, float a, float b,
+//Constructor from functors only
+Environment::Environment(vector<Population> sp, map<string,float> parameters, string filename, string genType, string repType, string variability) : numberOfChanges(int(parameters["m"]*parameters["n"]), 0)
+{   
+    //Extract the parameters
+    n = parameters["n"];    
+    m = parameters["m"];               
+    readParameters(parameters, variability);
+
+    //Construction of the environmental matrix (a percolation is a draw per node, its conditions are not stored in
+    //compact storage : conditions of the draws)
+    envFunctor intialEnv; 
+    if (genType=="percolation"){
+        levels.write().resize(m*n);
+        intialEnv(levels.write(), parameters, genType);
+        levelCount = 2;
+    }
+    if (!compactStorage or (levelCount==0)){
+        conditions.write().resize(m*n);
+        intialEnv(conditions.write(), parameters, genType);
+    }
+
+    //Species and their migration stencils
+    species = sp;
+    indexSpecies();
+    setNeighbourhood(neighbourhood);
+
+    //Construction of the intial repartition
+    repartition.resize(m*n);
+    repFunctor initialRep;
+    initialRep(repartition, m, n, sp, repType, rng);
+
+    //Add the parameters and species used in the name of the environment
+    name = makeName(filename, parameters, sp);
+
+    //Make the adaptationScore grid of each species if the environment is constant (otherwise useless)
+    if(envType=="constant")
+    {
+        for (int i=0; i<int(sp.size()); i++)
+        {
+            adaptationScores.insert({sp[i].name, scoreLayer(sp[i])});
+        }
+    }
+}
+
+//Constructor from functors and image to set environmental parameters
+Environment::Environment(const Raster& image, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability) : numberOfChanges(int(parameters["m"]*parameters["n"]), 0)
+{   
+    //Extract the parameters
+    n = parameters["n"];    
+    m = parameters["m"];
+    readParameters(parameters, variability);
+
+    //Construction of the environmental matrix (not stored in compact storage : conditions of the pixel values)
+    if (!compactStorage){
+        envFunctor intialEnv;
+        conditions.write().resize(m*n);
+        intialEnv(conditions.write(), m, n, image);
+    }
+
+    //Pixel value of every node (the scores of the species are tables of the levels)
+    vector<uint16_t>& level = levels.write();
+    level.resize(m*n);
+    levelCount = 256;
+    for (int y=0; y<m; y++){
+        for (int x=0; x<n; x++){level[y*n+x] = image.red(x, y);}
+    }
+
+    //Species and their migration stencils
+    species = sp;
+    indexSpecies();
+    setNeighbourhood(neighbourhood);
+
+    //Construction of the intial repartition
+    repartition.resize(m*n);
+    repFunctor initialRep;
+    initialRep(repartition, m, n, sp, repType, rng);
+
+    //Add the parameters and species used in the name of the environment
+    name = makeName(filename, parameters, sp);
+
+    //Make the adaptationScore table of each species
+    for (int i=0; i<int(sp.size()); i++)
+    {
+        adaptationScores.insert({sp[i].name, scoreLayer(sp[i])});
+    }
+}
+
+//Constructor from functors and two images to set environmental parameters
+Environment::Environment(const Raster& image1, const Raster& image2, vector<Population> sp, map<string,float> parameters, string filename, string repType, string variability) : numberOfChanges(int(parameters["m"]*parameters["n"]), 0)
+{   
+    //Extract the parameters
+    n = parameters["n"];    
+    m = parameters["m"];
+    readParameters(parameters, variability);
+
+    //Construction of the environmental matrix (not stored in compact storage : conditions of the pixel values)
+    if (!compactStorage){
+        envFunctor intialEnv;
+        conditions.write().resize(m*n);
+        intialEnv(conditions.write(), m, n, image1, image2);
+    }
+
+    //Pair of pixel values of every node (the scores of the species are tables of the levels)
+    vector<uint16_t>& level = levels.write();
+    level.resize(m*n);
+    levelCount = 65536;
+    for (int y=0; y<m; y++){
+        for (int x=0; x<n; x++){level[y*n+x] = 256*image1.red(x, y) + image2.red(x, y);}
+    }
+
+    //Species and their migration stencils
+    species = sp;
+    indexSpecies();
+    setNeighbourhood(neighbourhood);
+
+    //Construction of the intial repartition
+    repartition.resize(m*n);
+    repFunctor initialRep;
+    initialRep(repartition, m, n, sp, repType, rng);
+
+    //Add the parameters and species used in the name of the environment
+    name = makeName(filename, parameters, sp);
+
+    //Make the adaptationScore table of each species
+    for (int i=0; i<int(sp.size()); i++)
+    {
+        adaptationScores.insert({sp[i].name, scoreLayer(sp[i])});
+    }
+}
+
+//Constructor on the layers of a site : the conditions, and the scores of the species already scored on the site,
+//are shared with the site instead of being computed again (runs of a sweep on the same images)
+Environment::Environment(const Environment& site, vector<Population> sp, map<string,float> parameters, string filename, string repType) : numberOfChanges(site.m*site.n, 0)
+{
+    //Extract the parameters (the size and the variability are the ones of the site)
+    n = site.n;
+    m = site.m;
+    readParameters(parameters, site.envType);
+
+    //Environmental matrix of the site
+    conditions = site.conditions;
+    levels = site.levels;
+    levelCount = site.levelCount;
+
+    //Species and their migration stencils
+    species = sp;
+    indexSpecies();
+    setNeighbourhood(neighbourhood);
+
+    //Construction of the intial repartition
+    repartition.resize(m*n);
+    repFunctor initialRep;
+    initialRep(repartition, m, n, sp, repType, rng);
+
+    //Add the parameters and species used in the name of the environment
+    name = makeName(filename, parameters, sp);
+
+    //Scores of the species (shared if the site has the scores of the same species)
+    if ((site.adaptationScores.size()!=0) or (envType=="constant"))
+    {
+        for (int i=0; i<int(sp.size()); i++)
+        {
+            auto same = find_if(site.species.begin(), site.species.end(), [&](const Population& other){
+                return (other==sp[i]) and (other.niche.parameters==sp[i].niche.parameters) and (other.tolerance==sp[i].tolerance);
+            });
+            if ((same != site.species.end()) and (site.adaptationScores.count(sp[i].name)!=0)){
+                adaptationScores.insert({sp[i].name, site.adaptationScores.at(sp[i].name)});
+            }
+            else {
+                adaptationScores.insert({sp[i].name, scoreLayer(sp[i])});
+            }
+        }
+    }
+}
+
+//Parameters of the automaton and random stream (shared by the constructors)
+void Environment::readParameters(map<string,float> parameters, string variability)
+{
+    if (parameters.find("unit") != parameters.end()){envDilatation = parameters["unit"];} 
+    if (parameters.find("envDilatation") != parameters.end()){envDilatation = parameters["envDilatation"];}        
+    if (parameters.find("envDelay") != parameters.end()){envDelay = parameters["envDelay"];}
+    if (parameters.find("distMean") != parameters.end()){distMean = parameters["distMean"];} 
+    if (parameters.find("distVar") != parameters.end()){distVar = parameters["distVar"];} 
+    if (parameters.find("percolationProbability") != parameters.end()){percolationProbability = parameters["percolationProbability"];} 
+    envType = variability;
+    if (parameters.find("dispersalProbability") != parameters.end()){dispersalProbability = parameters["dispersalProbability"];}
+    if (parameters.find("softmaxTemperature") != parameters.end()){softmaxTemperature = parameters["softmaxTemperature"];}
+    if (parameters.find("distanceThreshold") != parameters.end()){distanceThreshold = parameters["distanceThreshold"];}
+    if (parameters.find("hybridProbability") != parameters.end()){hybridProbability = parameters["hybridProbability"];}
+    if (parameters.find("maxSpecies") != parameters.end()){maxSpecies = parameters["maxSpecies"];}
+    if (parameters.find("compactStorage") != parameters.end()){compactStorage = (parameters["compactStorage"]!=0);}
+    rng = CounterRNG(parameters.count("seed") ? uint32_t(parameters["seed"]) : 1, parameters.count("replicate") ? uint32_t(parameters["replicate"]) : 0);
+}
+
+//Conditions of the node c (from its level if the conditions are not stored)
+Conditions Environment::conditionsAt(int c) const
+{
+    if (this->conditions.size()!=0){return this->conditions[c].parameters;}
+    envFunctor f;
+    return f.levelConditions((*this->levels)[c], this->levelCount);
+}
+
+//Conditions of every node (the stored layer, or a layer built from the levels)
+Shared<vector<VariableEnv<Conditions>>> Environment::conditionLayer() const
+{
+    if ((this->conditions.size()!=0) or (this->levelCount==0)){return this->conditions;}
+    vector<VariableEnv<Conditions>> layer(this->m*this->n);
+    for (int c=0; c<this->m*this->n; c++){layer[c].parameters = this->conditionsAt(c);}
+    return layer;
+}
+
+//Diffusion of the species on the grid (determinist or stochastic)
+Environment Environment::migration()
+{
+    PROFILE_PHASE(MIGRATION_PHASE);
+
+    //Stencils of every species present (built before the copy so the new environment keeps them)
+    for (int k=0; k<int(this->species.size()); k++){this->stencil(this->species[k].diffusion_speed);}
+
+    //New environment
+    Environment newEnv(*this);
+
+    //In stochastic migration each (source, target) pair is colonised with probability dispersalProbability.
+    //The draw is keyed on (step, source, target) so it does not depend on the order of the loops.
+    bool stochastic = (this->migrationType=="stochastic");
+    auto arrives = [&](int source, int target){
+        return (!stochastic or this->rng.bernoulli(this->dispersalProbability, MIGRATION, this->step, source, target));
+    };
+
+    //Lattice padded with a halo : every padded node is mapped to a node of the lattice, or to the sink node m*n
+    //(outside an open boundary), so the stencils are applied without any bound check
+    int width = this->n+2*this->halo;
+    vector<int> fold = haloMap(this->m, this->n, this->halo, this->halo, this->rowBoundary, this->columnBoundary);
+    newEnv.repartition.resize(this->m*this->n+1);
+
+    //Species already arrived in each node (bitmask of the indices of the species list, in words of 64 bits) : a species
+    //is added once to the candidates of a node, at its first arrival (the occupant is there from the start)
+    int words = (this->species.size()+63)/64;
+    vector<uint64_t> arrived(size_t(this->m*this->n+1)*words, 0);
+    auto arrive = [&](int target, int id, int k){
+        vector<int>& candidates = newEnv.repartition[target];
+        if (k < 0){
+            if (find(candidates.begin(), candidates.end(), id) == candidates.end()){candidates.push_back(id);}     //Species out of the list
+            return;
+        }
+        uint64_t& word = arrived[size_t(target)*words+(k>>6)];
+        uint64_t bit = uint64_t(1) << (k&63);
+        if (!(word & bit)){word |= bit; candidates.push_back(id);}
+    };
+    for (int c=0; c<this->m*this->n; c++){
+        for (int id : this->repartition[c]){
+            int k = this->speciesIndex(id);
+            if (k >= 0){arrived[size_t(c)*words+(k>>6)] |= uint64_t(1) << (k&63);}
+        }
+    }
+
+    //Species with a large diffusion speed : the nodes reached by each source come from the first source of every node
+    //(firstSourceFunctor), linear in the number of nodes whatever the speed. A node holds one species, so the nodes
+    //reached from each source are listed once for all these species (reached[start[source]] to reached[start[source+1]]).
+    vector<int> start, reached;
+    vector<Vecteur<int>> firsts;
+    for (int s=0; s<int(this->species.size()); s++){
+        const Population& sp = this->species[s];
+        if (!this->usesDistance(sp.diffusion_speed)){continue;}
+        firstSourceFunctor firstSource;
+        firsts.push_back(firstSource(this->repartition, sp, this->m, this->n, this->neighbourhood, fold, this->halo, sp.diffusion_speed));
+    }
+    if (firsts.size()!=0){
+        start.assign(this->m*this->n+2, 0);
+        for (auto& first : firsts){
+            for (int c=0; c<this->m*this->n; c++){
+                if (first[c] < this->m*this->n){start[first[c]+2] += 1;}
+            }
+        }
+        for (int c=2; c<this->m*this->n+2; c++){start[c] += start[c-1];}
+        reached.resize(start[this->m*this->n+1]);
+        for (auto& first : firsts){
+            for (int c=0; c<this->m*this->n; c++){
+                if (first[c] < this->m*this->n){reached[start[first[c]+1]++] = c;}
+            }
+        }
+    }
+
+    //Arrivals from the sources in row-major order
+    for (int i=0; i<this->m; i++){
+        for (int j=0; j<this->n; j++){
+            int source = i*this->n+j;
+            if (this->repartition[source].size()!=0)
+            {
+                const Population& sp = this->population(this->repartition[source][0]);
+                int index = this->speciesIndex(sp.id);
+                if ((index >= 0) and this->usesDistance(sp.diffusion_speed)){
+                    for (int r=start[source]; r<start[source+1]; r++){arrive(reached[r], sp.id, index);}
+                    continue;
+                }
+                const Stencil& st = this->stencil(sp.diffusion_speed);
+
+                int padded = (i+this->halo)*width+j+this->halo;
+                for (int k=0; k<st.size(); k++){
+                    int target = fold[padded+st.flat[k]];
+                    if (arrives(source, target)){arrive(target, sp.id, index);}
+                }
+            }
+        }
+    }
+
+    //Drop the sink node
+    newEnv.repartition.pop_back();
+    
+    return newEnv;
+}
+
+//Selection of the best adapted Population in each node of the grid (determinist or stochastic)
+Environment Environment::selection(){
+    PROFILE_PHASE(SELECTION_PHASE);
+
+    //New environment
+    Environment newEnv(*this);
+
+    //Scores of the candidates of one node (buffer reused for every node)
+    Vecteur<float> scores;
+    gaussianScore scoreFunction;
+
+    //Score layer of each species of the list, looked up once (a species out of the list is looked up by name)
+    vector<const ScoreLayer*> layers(this->species.size(), nullptr);
+    if (this->envType=="constant"){
+        for (int k=0; k<int(this->species.size()); k++){layers[k] = &this->adaptationScores[this->species[k].name];}
+    }
+    auto layer = [&](int id){
+        int k = this->speciesIndex(id);
+        return (k >= 0) ? layers[k] : &this->adaptationScores[this->population(id).name];
+    };
+
+    for (int i=0; i<this->m; i++){
+        for (int j=0; j<this->n; j++){
+            if (this->repartition[i*this->n+j].size()!=0){
+                const vector<int>& candidates = this->repartition[i*this->n+j];
+                scores.resize(candidates.size());
+
+                //If the environnement is variable (changing with time) re-calculate everytime all the scores
+                if (this->envType=="variable"){
+                    for (int k=0; k<int(candidates.size()); k++){
+                        scores[k] = scoreFunction(this->conditionsAt(i*this->n+j), this->population(candidates[k]));
+                    }
+                }
+
+                //If the environnement is constant use pre-calculated scores
+                else if (this->envType=="constant"){
+                    for (int k=0; k<int(candidates.size()); k++){
+                        scores[k] = (*layer(candidates[k]))[i*this->n+j];
+                    }
+                }
+
+                int ind = this->chooseCandidate(candidates, scores, i*this->n+j, this->step);
+                int winner = candidates[ind];
+
+                //Two species meeting : the invader may give its hybrid with the first candidate (new species at its first appearance)
+                if ((this->hybridProbability > 0) and (winner != candidates[0])
+                    and this->rng.bernoulli(this->hybridProbability, HYBRIDISATION, this->step, i*this->n+j)){
+                    int infant = newEnv.hybrid(candidates[0], winner);
+                    if (infant >= 0){winner = infant;}
+                }
+                
+                if (newEnv.repartition[i*this->n+j].size()!=0){
+                    if (winner!=candidates[0])
+                    {
+                        newEnv.numberOfChanges[i*this->n+j]+=1;
+                    }
+
+                    newEnv.repartition[i*this->n+j]=vector<int>({winner});
+                }
+            }
+        }
+    }
+
+    newEnv.step = this->step+1;
+    return newEnv;
+}
+
+//Set the neighbourhood of the migration and precompute the stencil of each distinct diffusion speed
+void Environment::setNeighbourhood(string shape, const Vecteur<Vecteur<int>>& kernel){
+    this->neighbourhood = shape;
+    this->neighbourhoodKernel = kernel;
+    this->stencils.clear();
+    this->halo = 0;
+    for (int k=0; k<int(this->species.size()); k++){this->stencil(this->species[k].diffusion_speed);}
+}
+
+//True if the reach of a diffusion speed is computed with the minimum filter (firstSourceFunctor) instead of the stencil
+//(only for the determinist migration with a "vonNeumann" or "moore" neighbourhood)
+bool Environment::usesDistance(int speed) const{
+    if ((this->migrationType!="determinist") or (this->neighbourhood=="custom")){return false;}
+    if (this->migrationMethod=="distance"){return true;}
+    if (this->migrationMethod=="auto"){return (speed >= this->distanceThreshold);}
+    return false;
+}
+
+//Stencil of a diffusion speed (built the first time the speed is met)
+const Stencil& Environment::stencil(int speed){
+    auto it = this->stencils.find(speed);
+    if (it == this->stencils.end()){
+        Stencil st(this->neighbourhood, speed, this->n+2*this->halo, this->neighbourhoodKernel);
+
+        //A larger stencil widens the halo : the flat offsets of the other stencils change
+        if (st.radius > this->halo){
+            this->halo = st.radius;
+            for (auto& other : this->stencils){other.second.setWidth(this->n+2*this->halo);}
+            st.setWidth(this->n+2*this->halo);
+        }
+        it = this->stencils.insert({speed, st}).first;
+    }
+    return it->second;
+}
+
+//Index of the candidate that wins a node, given the scores of the candidates (distinct species ids, or species indices of
+//TemporalBlocking, in the order of their first arrival)
+template<class Candidates>
+int Environment::chooseCandidate(const Candidates& candidates, const Vecteur<float>& scores, int cell, int iteration) const{
+
+    //Determinist : best score (the current occupant wins ties)
+    if (this->selectionType=="determinist"){
+        int ind(0);
+        for (int k=1; k<int(candidates.size()); k++){
+            if (scores[k] > scores[ind]){ind = k;}
+        }
+        return ind;
+    }
+
+    //Stochastic : each species is drawn with a weight given by its score (proportional) or exp(score/T) (softmax)
+    float maxScore = *max_element(scores.begin(), scores.end());
+    Vecteur<float> weights(candidates.size(), 0);
+    float total = 0;
+    for (int k=0; k<int(candidates.size()); k++){
+        if (this->selectionType=="proportional"){weights[k] = scores[k];}
+        else if (this->selectionType=="softmax"){weights[k] = exp((scores[k]-maxScore)/this->softmaxTemperature);}
+        total += weights[k];
+    }
+    if (total <= 0){return 0;}
+
+    float u = this->rng.uniform(SELECTION, iteration, cell) * total;
+    float cumulated = 0;
+    int last = 0;
+    for (int k=0; k<int(candidates.size()); k++){
+        if (weights[k] <= 0){continue;}
+        cumulated += weights[k];
+        last = k;
+        if (u < cumulated){return k;}
+    }
+    return last;
+}
+
+template int Environment::chooseCandidate(const vector<int>& candidates, const Vecteur<float>& scores, int cell, int iteration) const;
+
+//True if a Simulation can skip the nodes that do not change (see EventDriven.hpp) : determinist run in a
+//constant environment, every node holding at most one species of the species list
+bool Environment::usesEventDriven() const{
+    if ((this->solver!="auto") or (this->hybridProbability > 0)){return false;}
+    if ((this->envType!="constant") or (this->migrationType!="determinist") or (this->selectionType!="determinist")){return false;}
+    for (int k=0; k<int(this->species.size()); k++){
+        if (this->adaptationScores.count(this->species[k].name)==0){return false;}
+    }
+    for (int c=0; c<int(this->repartition.size()); c++){
+        if (this->repartition[c].size() > 1){return false;}
+        if ((this->repartition[c].size()==1) and (this->speciesIndex(this->repartition[c][0]) < 0)){return false;}
+    }
+    return true;
+}
+
+//True if a Simulation can advance several iterations per tile (see TemporalBlocking.hpp) : "tiled" solver, or "auto"
+//on a large lattice
+bool Environment::usesTemporalBlocking() const{
+    if (this->solver=="iterative"){return false;}
+    if ((this->solver=="auto") and (this->m*this->n < this->tiledThreshold)){return false;}
+    return this->supportsTiles();
+}
+
+//True if a Simulation runs as several processes, each one owning a band of rows (see DomainDecomposition.hpp)
+bool Environment::usesDomainDecomposition() const{
+    if ((this->processes <= 1) or (this->solver=="iterative")){return false;}
+    return this->supportsTiles();
+}
+
+//True if the rule can run on tiles (TemporalBlocking) : every node holds at most one species of the species list.
+//Across a reflective boundary the images of the sources are only exact with stencils symmetric along both axes.
+bool Environment::supportsTiles() const{
+    if ((this->envType!="constant") and (this->envType!="variable")){return false;}
+    if (this->hybridProbability > 0){return false;}     //The species list changes during the run
+    bool reflective = (this->rowBoundary=="reflective") or (this->columnBoundary=="reflective");
+    for (int k=0; k<int(this->species.size()); k++){
+        if ((this->envType=="constant") and (this->adaptationScores.count(this->species[k].name)==0)){return false;}
+        auto it = this->stencils.find(this->species[k].diffusion_speed);
+        if (it == this->stencils.end()){return false;}
+        if (reflective){
+            const Stencil& st = it->second;
+            set<pair<int,int>> offsets;
+            for (int o=0; o<st.size(); o++){offsets.insert({st.di[o], st.dj[o]});}
+            for (auto& o : offsets){
+                if ((offsets.count({-o.first, o.second})==0) or (offsets.count({o.first, -o.second})==0)){return false;}
+            }
+        }
+    }
+    for (int c=0; c<int(this->repartition.size()); c++){
+        if (this->repartition[c].size() > 1){return false;}
+        if ((this->repartition[c].size()==1) and (this->speciesIndex(this->repartition[c][0]) < 0)){return false;}
+    }
+    return true;
+}
+
+//Change in the environment according to the functor : f_t(conditions)
+Environment Environment::environmentalChange(float t){   
+    PROFILE_PHASE(ENV_CHANGE_PHASE);
+    vector<VariableEnv<Conditions>>& cond = this->conditions.write();       //Own copy of the conditions (shared with the other environments)
+    cond.resize(this->m*this->n);                                            //(not stored yet in compact storage)
+    this->levels = Shared<vector<uint16_t>>();                             //The conditions are no more the ones of the levels
+    this->levelCount = 0;
+    for (int i=0; i<this->m; i++){
+        for (int j=0; j<this->n; j++){
+            envChangeFunctor f;
+            cond[i*this->n+j] = f(this->unit, i, j, this->m, this->n, t, this->envDilatation, this->envDelay);
+        }
+    }
+    return *this;
+} 
+
+//Count the number of individuals in each populations
+Vecteur<float> Environment::countPopulations(){
+    Vecteur<float> counts(this->species.size(),0);
+    for (int i=0; i<this->m; i++){
+        for (int j=0; j<this->n; j++){
+            if (this->repartition[i*this->n+j].size()!=0){
+                counts[this->speciesIndex(this->repartition[i*this->n+j][0])]+=1;
+            }
+        }
+    }
+    return counts;
+}
+
+//Index of a species id in the species list (-1 if the species is not in the list). The table is checked
+//against the list, which can be assigned directly : a stale entry falls back to a scan of the list.
+int Environment::speciesIndex(int id) const{
+    if ((id >= 0) and (id < int(this->speciesTable.size()))){
+        int k = this->speciesTable[id];
+        if ((k >= 0) and (k < int(this->species.size())) and (this->species[k].id==id)){return k;}
+    }
+    for (int k=0; k<int(this->species.size()); k++){
+        if (this->species[k].id==id){return k;}
+    }
+    return -1;
+}
+
+//Table of the indices of the ids in the species list (after every change of the list)
+void Environment::indexSpecies(){
+    this->speciesTable.clear();
+    for (int k=0; k<int(this->species.size()); k++){
+        int id = this->species[k].id;
+        if (id < 0){continue;}
+        if (id >= int(this->speciesTable.size())){this->speciesTable.resize(id+1, -1);}
+        if (this->speciesTable[id] < 0){this->speciesTable[id] = k;}
+    }
+}
+
+//Add a species to the list (if it is not in it yet) : its score layer is computed now, the layers of the
+//other species are kept. Index of the species in the list.
+int Environment::addSpecies(const Population& sp){
+    int k = this->speciesIndex(sp.id);
+    if (k >= 0){return k;}
+    this->species.write().push_back(sp);
+    if ((this->envType=="constant") and (this->adaptationScores.count(sp.name)==0)){
+        this->adaptationScores.insert({sp.name, this->scoreLayer(sp)});
+    }
+    this->stencil(sp.diffusion_speed);
+    this->indexSpecies();
+    return this->species.size()-1;
+}
+
+//Score layer of a species : table of the levels if the environment has levels (the score of a node only depends
+//on its pixel values or percolation draw), score of every node otherwise (ranks in compact storage)
+ScoreLayer Environment::scoreLayer(const Population& sp) const{
+    adaptationScoreFunctor f;
+    if (this->levelCount > 0){return ScoreLayer(f(*this->levels, this->levelCount, sp), this->levels);}
+    ScoreLayer layer(f(this->conditions, sp, this->m, this->n));
+    return this->compactStorage ? layer.compact() : layer;
+}
+
+//Id of the hybrid of two species (created and added to the species list the first time the pair meets,
+//-1 if the list is full)
+int Environment::hybrid(int first, int invader){
+    auto it = this->hybrids->find({first, invader});
+    if (it != this->hybrids->end()){return it->second;}
+    if (int(this->species.size()) >= this->maxSpecies){return -1;}
+    Population infant = mean(this->population(first), this->population(invader));
+    this->addSpecies(infant);
+    this->hybrids.write()[{first, invader}] = infant.id;
+    return infant.id;
+}
+
+//Population of a species id : the species of the list, or the Population registered with its name
+const Population& Environment::population(int id) const{
+    int k = this->speciesIndex(id);
+    return (k >= 0) ? this->species[k] : Population::registered(id);
+}
+
+//Number of pairs of neighbouring nodes (along the rows and the columns) holding different species or
+//a species and nothing : length of the fronts and of the boundaries between the species
+int Environment::interfaceLength() const{
+    int length = 0;
+    auto differ = [&](int c, int d){
+        const vector<int>& a = this->repartition[c];
+        const vector<int>& b = this->repartition[d];
+        if ((a.size()==0) or (b.size()==0)){return (a.size()!=b.size());}
+        return (a[0]!=b[0]);
+    };
+    for (int i=0; i<this->m; i++){
+        int below = boundaryIndex(i+1, this->m, this->rowBoundary);
+        for (int j=0; j<this->n; j++){
+            int right = boundaryIndex(j+1, this->n, this->columnBoundary);
+            if ((right >= 0) and differ(i*this->n+j, i*this->n+right)){length++;}
+            if ((below >= 0) and differ(i*this->n+j, below*this->n+j)){length++;}
+        }
+    }
+    return length;
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include "EventDriven.hpp"
+#include "Profiler.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+EventDriven::EventDriven(Environment& env)
+{
+    int S = env.species.size();
+
+    //Stencils of every species (may widen the halo), then the map of the padded lattice
+    for (int k=0; k<S; k++){env.stencil(env.species[k].diffusion_speed);}
+    fold = haloMap(env.m, env.n, env.halo, env.halo, env.rowBoundary, env.columnBoundary);
+
+    for (int k=0; k<S; k++){
+        scores.push_back(&env.adaptationScores.at(env.species[k].name));
+    }
+
+    //Every occupied node is a source of the first iteration
+    occupant.assign(env.m*env.n, -1);
+    counts.assign(S, 0);
+    for (int c=0; c<env.m*env.n; c++){
+        if (env.repartition[c].size()!=0){
+            occupant[c] = env.speciesIndex(env.repartition[c][0]);
+            counts[occupant[c]] += 1;
+            frontier.push_back(c);
+        }
+    }
+
+    first.resize(env.m*env.n);
+    best.resize(env.m*env.n);
+    stamp.assign(env.m*env.n, -1);
+}
+
+//One iteration : arrivals from the frontier, then selection on the reached nodes
+int EventDriven::advance(Environment& env)
+{
+    int width = env.n+2*env.halo;
+    iteration++;
+
+    //Candidate k reaches the node d (called in the order of the candidates list of Environment::migration,
+    //the occupant being the first candidate, so the first best score wins as in Environment::chooseCandidate)
+    touched.clear();
+    auto arrive = [&](int d, int k){
+        if (stamp[d] != iteration){
+            stamp[d] = iteration;
+            touched.push_back(d);
+            first[d] = (occupant[d] >= 0) ? occupant[d] : k;
+            best[d] = first[d];
+        }
+        if ((*scores[k])[d] > (*scores[best[d]])[d]){best[d] = k;}
+    };
+
+    {
+        PROFILE_PHASE(MIGRATION_PHASE);
+        auto propagate = [&](int source){
+            int k = occupant[source];
+            const Stencil& st = env.stencils.at(env.species[k].diffusion_speed);
+            int padded = (source/env.n+env.halo)*width + source%env.n+env.halo;
+            for (int o=0; o<st.size(); o++){
+                int target = fold[padded+st.flat[o]];
+                if (target < env.m*env.n){arrive(target, k);}
+            }
+        };
+
+        //Sources in row-major order (the species using the minimum filter have the same reach and order)
+        for (int source : frontier){propagate(source);}
+    }
+
+    //Selection : the reached nodes whose best candidate is not the occupant change
+    {
+        PROFILE_PHASE(SELECTION_PHASE);
+        frontier.clear();
+        for (int d : touched){
+            int winner = best[d];
+            if (winner == occupant[d]){continue;}
+
+            //Counted when the winner is not the first candidate (the occupant, or the first arrival on an empty node)
+            if ((occupant[d] >= 0) or (winner != first[d])){env.numberOfChanges[d] += 1;}
+
+            if (occupant[d] >= 0){counts[occupant[d]] -= 1;}
+            counts[winner] += 1;
+            occupant[d] = winner;
+            env.repartition[d] = vector<int>({env.species[winner].id});
+            frontier.push_back(d);
+        }
+        sort(frontier.begin(), frontier.end());
+    }
+
+    env.step += 1;
+    return frontier.size();
+}
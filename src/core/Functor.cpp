@@ -0,0 +1,382 @@
+#include "Functor.hpp"
+
+using namespace std;
+
+//======================================================================
+//                    Linear algebra functions toolbox 
+//======================================================================
+
+// Perform Cholesky decomposition of a *symmetric positive definite* matrix A
+void choleskyDecomposition(const Tolerance &A, Tolerance &L){
+  int n = A.size();
+  L = Tolerance(n, Conditions(n, 0.0f));
+
+  for (int i = 0; i < n; ++i){
+    for (int j = 0; j <= i; ++j){
+      float sum = 0.0f;
+      // Calculate the sum for the current element
+      for (int k = 0; k < j; ++k){
+        sum += L[i][k] * L[j][k];
+      }
+      if (i == j){
+        // Diagonal elements
+        L[i][j] = sqrt(A[i][i] - sum);
+      } 
+      else{
+        // Off-diagonal elements
+        L[i][j] = (A[i][j] - sum) / L[j][j];
+      }
+    }
+  }
+}
+
+// Compute the determinant of A = L^T * L
+float determinant(const Tolerance &L){
+  float det = 1.0f;
+  for (int i = 0; i < L.size(); ++i){
+    det *= L[i][i];
+  }
+  return det * det; // Determinant of A = (det(L))^2
+}
+
+// Solve Ax=b using Cholesky decomposition L of A
+Conditions solveCholesky(const Tolerance &L, const Conditions &b){
+  int n = b.size();
+  Conditions y(n, 0.0f);
+  Conditions x(n, 0.0f);
+
+  // Forward substitution to solve Ly = b
+  for (int i = 0; i < n; ++i){
+    float sum = 0.0f;
+    for (int j = 0; j < i; ++j){
+      sum += L[i][j] * y[j];
+    }
+    y[i] = (b[i] - sum) / L[i][i];
+  }
+
+  // Backward substitution to solve L^T x = y
+  for (int i = n - 1; i >= 0; --i){
+    float sum = 0.0f;
+    for (int j = i + 1; j < n; ++j){
+      sum += L[j][i] * x[j];
+    }
+    x[i] = y[i] - sum;
+  }
+
+  return x;
+}
+
+//======================================================================
+//                           Class repFunctor
+//              (To set the initial repartition of species)
+//======================================================================
+
+vector<vector<int>>& repFunctor::operator()(vector<vector<int>>& rep, float m, int n, vector<Population> sp, string gen, const CounterRNG& rng)
+{
+  if (gen == "bottomStart"){
+    for (int i=0; i<m; i++){
+      for (int j=0; j<n; j++){
+        if (i==m-1) {rep[i*n+j].push_back(sp[0].id);} 
+        else {rep[i*n+j].push_back(sp[1].id);} 
+      }
+    }
+  }
+  
+  if (gen == "centralStart"){
+    int mid_i = m/2;
+    int mid_j = n/2;
+    for (int i=0; i<m; i++){
+      for (int j=0; j<n; j++){ 
+        if ((i==mid_i-1) & (j==mid_j-1)) {rep[i*n+j].push_back(sp[0].id);}
+        else {rep[i*n+j].push_back(sp[1].id);} 
+      }
+    }
+  }
+
+  if (gen == "oppositeCornerStart"){
+    rep[(m-1)*n+(n-1)].push_back(sp[1].id);
+    rep[0].push_back(sp[0].id);
+  }
+
+  else if (gen == "pointStart"){
+    for (int i=0; i<m; i++){
+      for (int j=0; j<n; j++){
+        rep[i*n+j].push_back(sp[2].id); //Mask Population
+      }
+    }
+    
+    // Place n sub-population uniformally distributed on the grid (one counter block per pair of placements)
+    for(int k=0; k<n; k++){
+      array<uint32_t,4> draw = rng.block(INITIAL_REPARTITION, 0, k);
+      int i = CounterRNG::toInt(draw[0], 0, m-1);
+      int j = CounterRNG::toInt(draw[1], 0, n-1);
+      rep[i*n+j].pop_back();
+      rep[i*n+j].push_back(sp[0].id); 
+      
+      int i_bis = CounterRNG::toInt(draw[2], 0, m-1);
+      int j_bis = CounterRNG::toInt(draw[3], 0, n-1);
+      rep[i_bis*n+j_bis].pop_back();
+      rep[i_bis*n+j_bis].push_back(sp[1].id); 
+    }
+  }
+  return(rep);
+}
+
+//======================================================================
+//                           Class firstSourceFunctor
+//     (First node of a species reaching every node within a diffusion speed)
+//======================================================================
+
+// Minimum of the window [lo,hi] around each of the length values of a line (stride between the values),
+// with an increasing deque of the candidates : linear in the length whatever the window
+static void windowMinimum(int* values, int length, int stride, int lo, int hi, int none, vector<int>& line, vector<int>& queue)
+{
+  line.resize(length);
+  queue.resize(length);
+  for (int t=0; t<length; t++){line[t] = values[t*stride];}
+  int head = 0, tail = 0, next = 0;
+  for (int t=0; t<length; t++){
+    for (; next <= min(length-1, t+hi); next++){
+      while ((tail > head) and (line[queue[tail-1]] >= line[next])){tail--;}
+      queue[tail++] = next;
+    }
+    while ((tail > head) and (queue[head] < t+lo)){head++;}
+    values[t*stride] = (tail > head) ? line[queue[head]] : none;
+  }
+}
+
+// The source of the offset (di,dj) of a node is the node (i+di,j+dj) : a "moore" window is the square
+// [-speed,speed]^2. A "vonNeumann" window |di|+|dj| <= speed holds the offsets a*(1,1)+b*(1,-1) with
+// |a|,|b| <= speed/2 (di+dj even), and (1,0)+a*(1,1)+b*(1,-1) with a,b in [-(speed+1)/2,(speed-1)/2] (di+dj odd).
+Vecteur<int> firstSourceFunctor::operator()(const vector<vector<int>>& rep, const Population& sp, int m0, int n0, string neighbourhood,
+                                            const vector<int>& fold, int halo, int speed)
+{
+  int m = m0+2*halo;
+  int n = n0+2*halo;
+  const int NONE = m0*n0;
+
+  //Index of the nodes of the species on the padded lattice (and a row below it, reached by the odd offsets)
+  vector<int> source((m+1)*n, NONE);
+  for (int i=0; i<m0; i++){
+    for (int j=0; j<n0; j++){
+      if ((rep[i*n0+j].size()!=0) and (rep[i*n0+j][0]==sp.id)) {source[(i+halo)*n+j+halo] = i*n0+j;}
+    }
+  }
+
+  vector<int> line, queue;
+  auto rows = [&](vector<int>& values, int lo, int hi){
+    for (int i=0; i<=m; i++){windowMinimum(values.data()+i*n, n, 1, lo, hi, NONE, line, queue);}
+  };
+  auto columns = [&](vector<int>& values, int lo, int hi){
+    for (int j=0; j<n; j++){windowMinimum(values.data()+j, m+1, n, lo, hi, NONE, line, queue);}
+  };
+  auto diagonals = [&](vector<int>& values, int lo, int hi){        //Direction (1,1)
+    for (int j=0; j<n; j++){windowMinimum(values.data()+j, min(m+1, n-j), n+1, lo, hi, NONE, line, queue);}
+    for (int i=1; i<=m; i++){windowMinimum(values.data()+i*n, min(m+1-i, n), n+1, lo, hi, NONE, line, queue);}
+  };
+  auto antidiagonals = [&](vector<int>& values, int lo, int hi){    //Direction (1,-1)
+    for (int j=0; j<n; j++){windowMinimum(values.data()+j, min(m+1, j+1), n-1, lo, hi, NONE, line, queue);}
+    for (int i=1; i<=m; i++){windowMinimum(values.data()+i*n+n-1, min(m+1-i, n), n-1, lo, hi, NONE, line, queue);}
+  };
+
+  vector<int> first(source);
+  if (neighbourhood=="moore"){
+    rows(first, -speed, speed);
+    columns(first, -speed, speed);
+  }
+  else {
+    diagonals(first, -(speed/2), speed/2);
+    antidiagonals(first, -(speed/2), speed/2);
+    if (speed > 0){
+      vector<int> odd(source);
+      diagonals(odd, -((speed+1)/2), (speed-1)/2);
+      antidiagonals(odd, -((speed+1)/2), (speed-1)/2);
+      for (int p=0; p<m*n; p++){first[p] = min(first[p], odd[p+n]);}
+    }
+  }
+
+  //Nodes of the lattice : smallest source over the padded nodes mapped to the node
+  Vecteur<int> lattice(m0*n0, NONE);
+  for (int p=0; p<m*n; p++){
+    if (fold[p] < NONE){lattice[fold[p]] = min(lattice[fold[p]], first[p]);}
+  }
+  return lattice;
+}
+
+//======================================================================
+//                           Class envFunctor
+//(To set the initial environment - determinist and probabilist generation)
+//======================================================================
+
+vector<VariableEnv<Conditions>>& envFunctor::operator()(vector<VariableEnv<Conditions>>& env, map<string,float> parameters, string gen)
+{
+  int m = parameters["m"];
+  int n = parameters["n"];
+
+  //Every draw is keyed on (seed, replicate, cell) so the cells can be generated in any order
+  CounterRNG rng(parameters.count("seed") ? uint32_t(parameters["seed"]) : 1, parameters.count("replicate") ? uint32_t(parameters["replicate"]) : 0);
+
+  if (gen=="function"){
+    for (int i=0; i<m; i++){
+      for (int j=0; j<n; j++){
+        env[i*n+j].parameters=Conditions({0});
+      }
+    }
+  }
+  
+  if (gen=="percolation"){
+    vector<uint16_t> levels(m*n);
+    (*this)(levels, parameters, gen);
+    #pragma omp parallel for
+    for (int i=0; i<m; i++){
+      for (int j=0; j<n; j++){
+        env[i*n+j].parameters=levelConditions(levels[i*n+j], 2);
+      }
+    }
+  }
+
+  else if(gen=="normal"){
+    float mean = parameters["distMean"];
+    float sd = sqrt(parameters["distVar"]);
+    #pragma omp parallel for
+    for (int i=0; i<m; i++){
+      for (int j=0; j<n; j++){
+        env[i*n+j].parameters=Conditions({mean+sd*rng.normal(ENV_GENERATION, 0, i*n+j, 0), mean+sd*rng.normal(ENV_GENERATION, 0, i*n+j, 1), mean+sd*rng.normal(ENV_GENERATION, 0, i*n+j, 2)});  
+      }
+    }
+  }
+  return(env);
+}
+
+//Levels of a percolation environment : 0 if the node is drawn (conditions 0), 1 otherwise
+vector<uint16_t>& envFunctor::operator()(vector<uint16_t>& levels, map<string,float> parameters, string gen)
+{
+  int m = parameters["m"];
+  int n = parameters["n"];
+  CounterRNG rng(parameters.count("seed") ? uint32_t(parameters["seed"]) : 1, parameters.count("replicate") ? uint32_t(parameters["replicate"]) : 0);
+
+  if (gen=="percolation"){
+    float p = parameters["percolationProbability"]; //Site percolation critical value 0.59274605079210 from https://arxiv.org/abs/1507.03027
+    #pragma omp parallel for
+    for (int i=0; i<m; i++){
+      for (int j=0; j<n; j++){
+        levels[i*n+j] = rng.bernoulli(p, ENV_GENERATION, 0, i*n+j) ? 0 : 1;
+      }
+    }
+  }
+  return(levels);
+}
+
+//Environment from a single image 
+vector<VariableEnv<Conditions>>& envFunctor::operator()(vector<VariableEnv<Conditions>>& env, int m, int n, const Raster& image)
+{
+  for (int y = 0; y < m; ++y) {
+    for (int x = 0; x < n; ++x) {
+      env[y*n+x].parameters=(*this)(y, x, image);
+    }
+  }
+  return env;
+}
+
+//Environment from two images
+vector<VariableEnv<Conditions>>& envFunctor::operator()(vector<VariableEnv<Conditions>>& env, int m, int n, const Raster& image1,  const Raster& image2)
+{
+  for (int y = 0; y < m; ++y) {
+    for (int x = 0; x < n; ++x) {
+      env[y*n+x].parameters=(*this)(y, x, image1, image2);
+    }
+  }
+  return env;
+}
+
+//Conditions of the node (y,x) from a single image (depth)
+Conditions envFunctor::operator()(int y, int x, const Raster& image)
+{
+  return (*this)(image.red(x, y));
+}
+
+//Conditions of the node (y,x) from two images (depth and vegetation cover)
+Conditions envFunctor::operator()(int y, int x, const Raster& image1,  const Raster& image2)
+{
+  return (*this)(image1.red(x, y), image2.red(x, y));
+}
+
+//Conditions of a pixel value (depth)
+Conditions envFunctor::operator()(uint8_t red)
+{
+  return Conditions({(-1.f*static_cast<float>(red)+255.f)/255.f*15.f});
+}
+
+//Conditions of a pair of pixel values (depth and vegetation cover)
+Conditions envFunctor::operator()(uint8_t red1, uint8_t red2)
+{
+  return Conditions({(-1.f*static_cast<float>(red1)+255.f)/255.f*15.f, static_cast<float>(red2)/255.f*10.f});
+}
+
+//Conditions of a level of the lattice
+Conditions envFunctor::levelConditions(int level, int levelCount)
+{
+  if (levelCount==2){return Conditions({float(level)});}
+  if (levelCount==256){return (*this)(uint8_t(level));}
+  return (*this)(uint8_t(level>>8), uint8_t(level&255));
+}
+
+//======================================================================
+//                           Class gaussianScore
+//  (To compute adaptation score of a species in one place of the grid)
+//======================================================================
+
+float gaussianScore::operator()(const Conditions &x, const Population &sp)
+{
+  int k = x.size();
+  
+  Tolerance L;
+  choleskyDecomposition(sp.tolerance, L);
+  float toleranceDet = determinant(L);
+
+  // Compute the normalization constant
+  float norm_const = 1.f / pow(2.f * M_PI, k / 2.f) / std::sqrt(toleranceDet);
+
+  // Compute the exponent term
+  Conditions diff = x - sp.niche.parameters;
+
+  Conditions temp = solveCholesky(L, diff);
+  float exponent =  diff|temp;
+  exponent *= -0.5f;
+
+  // Compute the Gaussian value
+  return norm_const * exp(exponent);
+}
+
+//======================================================================
+//                           Class adaptationScoreFunctor
+// (To compute adaptation score of one species in all places of the grid)
+//======================================================================
+
+Vecteur<float> adaptationScoreFunctor::operator()(const vector<VariableEnv<Conditions>> &cond, Population sp, int m, int n)
+{
+  gaussianScore func;
+  Vecteur<float> grid(m*n);
+  for (int i=0; i<m; i++){
+    for (int j=0; j<n; j++){
+      grid[i*n+j] = func(cond[i*n+j].parameters, sp);
+    }
+  }
+  return(grid);
+}
+
+//Table of the scores of the levels (only the levels of the lattice are computed, the others are left at 0)
+Vecteur<float> adaptationScoreFunctor::operator()(const vector<uint16_t> &levels, int levelCount, Population sp)
+{
+  gaussianScore func;
+  envFunctor conditionsOf;
+  Vecteur<float> table(levelCount, 0.f);
+  vector<char> present(levelCount, 0);
+  for (uint16_t l : levels){present[l] = 1;}
+  for (int l=0; l<levelCount; l++){
+    if (present[l]){
+      table[l] = func(conditionsOf.levelConditions(l, levelCount), sp);
+    }
+  }
+  return(table);
+}
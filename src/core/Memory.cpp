@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <sys/resource.h>
+#include "Memory.hpp"
+
+using namespace std;
+
+MemoryCounters memoryCounters;
+
+//======================================================================
+//                          Functions
+//======================================================================
+
+//Peak resident memory of the process (kB)
+long peakResidentMemory()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+//Current state of the counters, the high-water mark of the live bytes restarts from now
+MemoryRecord memoryCheckpoint()
+{
+    MemoryRecord r;
+    r.allocations = memoryCounters.allocations;
+    r.bytes = memoryCounters.bytes;
+    r.peakLiveBytes = memoryCounters.peakLiveBytes;
+    memoryCounters.peakLiveBytes = long(memoryCounters.liveBytes);
+    return r;
+}
+
+//What happened since the checkpoint, the high-water mark goes back to the one of the enclosing checkpoint
+MemoryRecord memorySince(const MemoryRecord& start)
+{
+    MemoryRecord r;
+    r.allocations = memoryCounters.allocations - start.allocations;
+    r.bytes = memoryCounters.bytes - start.bytes;
+    r.peakLiveBytes = memoryCounters.peakLiveBytes;
+    memoryCounters.peakLiveBytes = max(r.peakLiveBytes, start.peakLiveBytes);
+    return r;
+}
+
+//======================================================================
+//                  Replacement of operator new/delete
+//======================================================================
+
+#ifdef MEMORY_TRACKING
+
+//Header in front of each block (keeps the default alignment)
+const size_t memoryHeader = alignof(max_align_t);
+
+void* operator new(size_t size)
+{
+    char* p = static_cast<char*>(malloc(size + memoryHeader));
+    if (p == nullptr){throw bad_alloc();}
+    *reinterpret_cast<size_t*>(p) = size;
+
+    memoryCounters.allocations.fetch_add(1, memory_order_relaxed);
+    memoryCounters.bytes.fetch_add(size, memory_order_relaxed);
+    long live = memoryCounters.liveBytes.fetch_add(size, memory_order_relaxed) + size;
+    long peak = memoryCounters.peakLiveBytes.load(memory_order_relaxed);
+    while ((live > peak) and !memoryCounters.peakLiveBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {}
+
+    return p + memoryHeader;
+}
+
+void operator delete(void* q) noexcept
+{
+    if (q == nullptr){return;}
+    char* p = static_cast<char*>(q) - memoryHeader;
+    memoryCounters.liveBytes.fetch_sub(*reinterpret_cast<size_t*>(p), memory_order_relaxed);
+    free(p);
+}
+
+void* operator new[](size_t size) {return operator new(size);}
+void operator delete[](void* q) noexcept {operator delete(q);}
+void operator delete(void* q, size_t) noexcept {operator delete(q);}
+void operator delete[](void* q, size_t) noexcept {operator delete(q);}
+
+#endif
@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "OutOfCore.hpp"
+#include "Functor.hpp"
+#include "Profiler.hpp"
+
+using namespace std;
+
+//======================================================================
+//                            Constructors
+//======================================================================
+
+//Empty lattice of parameters["m"] x parameters["n"] nodes : the rule is built on a single node
+OutOfCore::OutOfCore(vector<Population> sp, map<string,float> parameters, string dir, int side) : directory(dir)
+{
+    map<string,float> single(parameters);
+    single["m"] = 1;
+    single["n"] = 1;
+    rule = Environment(sp, single, "", "function", "", "variable");
+    rule.m = parameters["m"];
+    rule.n = parameters["n"];
+    rule.name = makeName("", parameters, sp);
+    create(side);
+}
+
+//Layers of an environment (the result of a run is the one of a Simulation of env)
+OutOfCore::OutOfCore(const Environment& env, string dir, int side) : directory(dir)
+{
+    rule = env;
+    create(side);
+
+    //Conditions
+    D = (m*n!=0) ? env.conditionsAt(0).size() : 0;
+    conditionsFile = mapFile("conditions.bin", nodes*D*sizeof(float));
+    conditions = (float*)conditionsFile.data;
+
+    //Scores of every species (the conditions do not change during a run)
+    for (int k=0; k<S; k++){
+        Vecteur<float> grid;
+        if (env.envType=="constant"){grid = env.adaptationScores.at(env.species[k].name).plane();}
+        else {grid = env.scoreLayer(env.species[k]).plane();}
+        for (int i=0; i<m; i++){
+            for (int j=0; j<n; j++){scores[address(i,j)*S+k] = grid[i*n+j];}
+        }
+    }
+
+    for (int i=0; i<m; i++){
+        for (int j=0; j<n; j++){
+            long a = address(i,j);
+            Conditions x = env.conditionsAt(i*n+j);
+            for (int d=0; d<D; d++){conditions[a*D+d] = x[d];}
+            int k = -1;
+            if (env.repartition[i*n+j].size()!=0){k = env.speciesIndex(env.repartition[i*n+j][0]);}
+            setOccupant(i, j, k);
+            changes[0][a] = env.numberOfChanges[i*n+j];
+        }
+    }
+}
+
+OutOfCore::~OutOfCore()
+{
+    for (MappedFile* f : {&occupantFile, &changesFile, &scoresFile, &conditionsFile, &colonisationFile}){
+        if (f->data != nullptr){munmap(f->data, f->bytes);}
+    }
+}
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+//Tile files of an empty lattice (the rule keeps no layer of the nodes)
+void OutOfCore::create(int side)
+{
+    if (rule.hybridProbability > 0){
+        cout << "the species of an out-of-core run are fixed (no hybrids) \n";
+        exit(1);
+    }
+    rule.conditions = {};
+    rule.levels = {};
+    rule.levelCount = 0;
+    rule.repartition.clear();
+    rule.numberOfChanges.clear();
+    rule.adaptationScores.clear();
+    rule.envType = "constant";
+    for (auto& sp : rule.species){rule.adaptationScores[sp.name] = Vecteur<float>();}    //The scores are in the tile files
+
+    tileSize = max(1, side);
+    m = rule.m;
+    n = rule.n;
+    S = rule.species.size();
+    tileRows = (m+tileSize-1)/tileSize;
+    tileColumns = (n+tileSize-1)/tileSize;
+    nodes = long(tileRows)*tileColumns*tileSize*tileSize;
+
+    mkdir(directory.c_str(), 0755);
+    occupantFile = mapFile("occupant.bin", 2*nodes*sizeof(int));
+    changesFile = mapFile("changes.bin", 2*nodes*sizeof(int));
+    scoresFile = mapFile("scores.bin", nodes*S*sizeof(float));
+    colonisationFile = mapFile("colonisation.bin", nodes*sizeof(int));
+    occupant[0] = (int*)occupantFile.data;
+    occupant[1] = occupant[0]+nodes;
+    changes[0] = (int*)changesFile.data;
+    changes[1] = changes[0]+nodes;
+    scores = (float*)scoresFile.data;
+    colonisation = (int*)colonisationFile.data;
+
+    fill(occupant[0], occupant[0]+2*nodes, -1);
+    fill(colonisation, colonisation+nodes, -1);
+    current.assign(tileRows*tileColumns, 0);
+    active.assign(tileRows*tileColumns, 1);
+    counts.assign(S, 0);
+}
+
+//File of the directory mapped in memory (created with the given size)
+OutOfCore::MappedFile OutOfCore::mapFile(const string& name, size_t bytes)
+{
+    MappedFile f;
+    f.bytes = max(bytes, size_t(1));
+    string path = directory + "/" + name;
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((fd < 0) or (ftruncate(fd, f.bytes) != 0)){cout << "cannot create the tile file " << path << "\n"; exit(1);}
+    f.data = mmap(nullptr, f.bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (f.data == MAP_FAILED){cout << "cannot map the tile file " << path << "\n"; exit(1);}
+    return f;
+}
+
+long OutOfCore::address(int i, int j) const
+{
+    return long(tileOf(i,j))*tileSize*tileSize + (i%tileSize)*tileSize + j%tileSize;
+}
+
+int OutOfCore::tileOf(int i, int j) const
+{
+    return (i/tileSize)*tileColumns + j/tileSize;
+}
+
+//Paging advice (MADV_WILLNEED, MADV_DONTNEED) on the pages holding the nodes of a tile
+void OutOfCore::advise(int t, int advice) const
+{
+    long page = sysconf(_SC_PAGESIZE);
+    long first = long(t)*tileSize*tileSize;
+    long count = long(tileSize)*tileSize;
+    auto range = [&](const MappedFile& f, void* base, long size){
+        if (f.data == nullptr){return;}
+        long begin = ((long)base + first*size)/page*page;
+        long end = min((long)base + (first+count)*size, (long)f.data + long(f.bytes));
+        if (end > begin){madvise((void*)begin, end-begin, advice);}
+    };
+    range(occupantFile, occupant[0], sizeof(int));
+    range(occupantFile, occupant[1], sizeof(int));
+    range(changesFile, changes[0], sizeof(int));
+    range(changesFile, changes[1], sizeof(int));
+    range(scoresFile, scores, S*sizeof(float));
+    range(conditionsFile, conditions, D*sizeof(float));
+    range(colonisationFile, colonisation, sizeof(int));
+}
+
+//Conditions and scores of every node, tile after tile (conditionsAt is called from several threads)
+void OutOfCore::setConditions(const function<Conditions(int,int)>& conditionsAt)
+{
+    if (conditions == nullptr){
+        D = conditionsAt(0, 0).size();
+        conditionsFile = mapFile("conditions.bin", nodes*D*sizeof(float));
+        conditions = (float*)conditionsFile.data;
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int t=0; t<tileRows*tileColumns; t++){
+        gaussianScore score;
+        int r0 = (t/tileColumns)*tileSize;
+        int c0 = (t%tileColumns)*tileSize;
+        for (int i=r0; i<min(r0+tileSize, m); i++){
+            for (int j=c0; j<min(c0+tileSize, n); j++){
+                long a = address(i,j);
+                Conditions x = conditionsAt(i,j);
+                for (int d=0; d<D; d++){conditions[a*D+d] = x[d];}
+                for (int k=0; k<S; k++){scores[a*S+k] = score(x, rule.species[k]);}
+            }
+        }
+        advise(t, MADV_DONTNEED);
+    }
+}
+
+//Initial occupant of a node
+void OutOfCore::setOccupant(int i, int j, int k)
+{
+    long a = address(i,j);
+    int* occ = occupant[current[tileOf(i,j)]];
+    if (occ[a] >= 0){counts[occ[a]] -= 1;}
+    if (k >= 0){counts[k] += 1;}
+    occ[a] = k;
+    colonisation[a] = (k >= 0) ? 0 : -1;
+}
+
+int OutOfCore::occupantAt(int i, int j) const
+{
+    return occupant[current[tileOf(i,j)]][address(i,j)];
+}
+
+int OutOfCore::colonisationAt(int i, int j) const
+{
+    return colonisation[address(i,j)];
+}
+
+//Iterations of the active tiles, up to the first one without change or nIter
+void OutOfCore::run(int nIter)
+{
+    if (!rule.supportsTiles()){cout << "the rule of the out-of-core run is not supported by the tiles (see Environment::supportsTiles) \n"; exit(1);}
+    TileKernel kernel(rule);
+    int nTiles = tileRows*tileColumns;
+
+    //Stochastic rules draw again at every iteration : a tile without change around it can still change
+    bool everyTile = (rule.migrationType!="determinist") or (rule.selectionType!="determinist");
+
+    timeBeforeStationarity = 0;
+    processedTiles = 0;
+    vector<int> tiles;
+    vector<char> changed(nTiles, 0);
+
+    for (int i=1; i<nIter; i++)
+    {
+        PROFILE_PHASE(TILED_PHASE);
+
+        tiles.clear();
+        for (int t=0; t<nTiles; t++){
+            if (everyTile or active[t]){tiles.push_back(t);}
+        }
+
+        int total = 0;
+        #pragma omp parallel
+        {
+            TileWindow w;
+            vector<int> delta(S, 0);
+
+            #pragma omp for schedule(dynamic) reduction(+:total)
+            for (int u=0; u<int(tiles.size()); u++){
+                if (u+1 < int(tiles.size())){advise(tiles[u+1], MADV_WILLNEED);}
+                int tileChanges = advanceTile(tiles[u], i, kernel, w, delta.data());
+                changed[tiles[u]] = (tileChanges > 0);
+                total += tileChanges;
+            }
+
+            #pragma omp critical
+            for (int k=0; k<S; k++){counts[k] += delta[k];}
+        }
+
+        //New buffers of the advanced tiles, then the tiles reached by the changes
+        fill(active.begin(), active.end(), 0);
+        for (int t : tiles){
+            current[t] = 1-current[t];
+            if (changed[t]){markNeighbours(t, kernel, active);}
+        }
+        for (int t : tiles){
+            if (!everyTile and !active[t]){advise(t, MADV_DONTNEED);}
+        }
+        processedTiles += tiles.size();
+        rule.step += 1;
+
+        if (total==0){timeBeforeStationarity = i-1; break;}
+    }
+}
+
+//One iteration of the tile t, loaded with its halo from the current buffers, written in the other buffer.
+//delta counts the nodes gained by each species.
+int OutOfCore::advanceTile(int t, int iteration, const TileKernel& kernel, TileWindow& w, int* delta)
+{
+    int H = kernel.radius;
+    int r0 = (t/tileColumns)*tileSize;
+    int c0 = (t%tileColumns)*tileSize;
+    int th = min(tileSize, m-r0);
+    int tw = min(tileSize, n-c0);
+    int wm = th+2*H;
+    int wn = tw+2*H;
+
+    //Load the tile and its halo (images of the nodes across a periodic or reflective boundary, -1 outside an open one)
+    w.resize(wm, wn, S);
+    for (int a=0; a<wm; a++){
+        int i = boundaryIndex(r0-H+a, m, rule.rowBoundary);
+        for (int b=0; b<wn; b++){
+            int j = boundaryIndex(c0-H+b, n, rule.columnBoundary);
+            int p = a*wn+b;
+            if ((i < 0) or (j < 0)){w.node[p] = -1; w.occ[p] = -1; w.chg[p] = 0; continue;}
+            long ad = address(i,j);
+            int buffer = current[tileOf(i,j)];
+            w.node[p] = i*n+j;
+            w.occ[p] = occupant[buffer][ad];
+            w.chg[p] = changes[buffer][ad];
+            copy(scores+ad*S, scores+(ad+1)*S, w.score.begin()+p*S);
+        }
+    }
+    w.sortSources = ((rule.rowBoundary!="open") and ((r0-H < 0) or (r0+th+H > m)))
+                    or ((rule.columnBoundary!="open") and ((c0-H < 0) or (c0+tw+H > n)));
+
+    int tileChanges = 0;
+    kernel.advance(rule, 1, w, th, tw, &tileChanges, delta);
+
+    //Write the tile in its other buffer
+    int in = current[t];
+    for (int a=H; a<H+th; a++){
+        for (int b=H; b<H+tw; b++){
+            int p = a*wn+b;
+            long ad = address(r0+a-H, c0+b-H);
+            occupant[1-in][ad] = w.occ[p];
+            changes[1-in][ad] = w.chg[p];
+            if (w.last[p] > 0){colonisation[ad] = iteration;}
+        }
+    }
+    return tileChanges;
+}
+
+//Tiles holding a node at most R nodes away from the tile t (across the boundaries)
+void OutOfCore::markNeighbours(int t, const TileKernel& kernel, vector<char>& next) const
+{
+    int R = kernel.radius;
+    int r0 = (t/tileColumns)*tileSize;
+    int c0 = (t%tileColumns)*tileSize;
+    vector<char> rows(tileRows, 0);
+    vector<char> columns(tileColumns, 0);
+    for (int i=r0-R; i<min(r0+tileSize, m)+R; i++){
+        int x = boundaryIndex(i, m, rule.rowBoundary);
+        if (x >= 0){rows[x/tileSize] = 1;}
+    }
+    for (int j=c0-R; j<min(c0+tileSize, n)+R; j++){
+        int x = boundaryIndex(j, n, rule.columnBoundary);
+        if (x >= 0){columns[x/tileSize] = 1;}
+    }
+    for (int a=0; a<tileRows; a++){
+        for (int b=0; b<tileColumns; b++){
+            if (rows[a] and columns[b]){next[a*tileColumns+b] = 1;}
+        }
+    }
+}
+
+//Repartition and numbers of changes of an environment of the same size
+void OutOfCore::writeBack(Environment& env) const
+{
+    for (int i=0; i<m; i++){
+        for (int j=0; j<n; j++){
+            int c = i*n+j;
+            int k = occupantAt(i,j);
+            if (k < 0){env.repartition[c].clear();}
+            else if ((env.repartition[c].size()!=1) or (env.repartition[c][0]!=env.species[k].id)){
+                env.repartition[c] = vector<int>({env.species[k].id});
+            }
+            env.numberOfChanges[c] = changes[current[tileOf(i,j)]][address(i,j)];
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#include <map>
+#include <mutex>
+#include <deque>
+#include "Population.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+Population::Population(VariableEnv<Conditions>& v, string Population, int speed, Tolerance tol)
+{
+    niche=v;
+    diffusion_speed=speed;
+    name=Population;
+    tolerance = tol;
+    id = intern(*this);
+}
+
+//Registry of the names of the species (never shrinks : the ids stay valid for the whole program)
+static mutex registryMutex;
+static map<string,int> registryIds;
+static deque<Population> registryPopulations;       //First Population of each id (stable references)
+
+int Population::intern(const Population& sp)
+{
+    lock_guard<mutex> lock(registryMutex);
+    auto it = registryIds.find(sp.name);
+    if (it != registryIds.end()){return it->second;}
+    int id = registryPopulations.size();
+    registryIds[sp.name] = id;
+    registryPopulations.push_back(sp);
+    registryPopulations.back().id = id;
+    return id;
+}
+
+const Population& Population::registered(int id)
+{
+    static const Population none;
+    lock_guard<mutex> lock(registryMutex);
+    return ((id >= 0) and (id < int(registryPopulations.size()))) ? registryPopulations[id] : none;
+}
+
+//======================================================================
+//                         External functions
+//======================================================================
+
+Population mean(Population A, Population B)
+{
+    VariableEnv<Conditions> newNiche((A.niche.parameters+B.niche.parameters)/float(2));
+    Population infant(newNiche,"("+A.name+B.name+")",min(A.diffusion_speed, B.diffusion_speed), A.tolerance);
+    return(infant);
+}
+
+ostream& operator <<(ostream & out, const Population& sp)
+{   
+    out << sp.name << ":" << sp.niche ;
+    return out;
+}
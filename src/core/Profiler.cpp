@@ -0,0 +1,91 @@
+#include <algorithm>
+#include "Profiler.hpp"
+
+using namespace std;
+
+//Profiler receiving the measures (set by the running Simulation)
+Profiler* activeProfiler = nullptr;
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+void Profiler::add(profilePhase phase, double seconds, long allocs, long bytes, long peak)
+{
+    time[phase] += seconds;
+    count[phase] += 1;
+    allocations[phase] += allocs;
+    allocatedBytes[phase] += bytes;
+    peakLiveBytes[phase] = max(peakLiveBytes[phase], peak);
+    if (!trace.empty()){trace.back()[phase] += seconds;}
+}
+
+//Start a new line of the trace
+void Profiler::newStep(int step)
+{
+    trace.push_back(array<double, N_PHASES>{});
+    traceStep.push_back(step);
+}
+
+void Profiler::reset()
+{
+    time.fill(0);
+    count.fill(0);
+    allocations.fill(0);
+    allocatedBytes.fill(0);
+    peakLiveBytes.fill(0);
+    trace.clear();
+    traceStep.clear();
+}
+
+//Summary of the run : time, share of the total and number of calls of each phase (and allocations)
+void Profiler::report(ostream& out) const
+{
+    double total = 0;
+    for (int k=0; k<N_PHASES; k++){total += time[k];}
+
+    //Keep the format of the stream
+    ios format(nullptr);
+    format.copyfmt(out);
+
+    out << "Profile (" << traceStep.size() << " iterations, " << fixed << setprecision(3) << total << " s)" << endl;
+    for (int k=0; k<N_PHASES; k++){
+        if (count[k]==0){continue;}
+        out << "  " << left << setw(20) << phaseNames[k] << right << setw(10) << setprecision(3) << time[k] << " s"
+            << setw(7) << setprecision(1) << (total > 0 ? 100*time[k]/total : 0) << " %"
+            << setw(10) << count[k] << " calls";
+#ifdef MEMORY_TRACKING
+        out << setw(12) << allocations[k] << " allocs" << setw(12) << setprecision(1) << allocatedBytes[k]/1048576. << " MB"
+            << setw(10) << setprecision(1) << peakLiveBytes[k]/1048576. << " MB peak";
+#endif
+        out << endl;
+    }
+    out.copyfmt(format);
+}
+
+//Write the per iteration trace (.json extension for JSON, CSV otherwise)
+void Profiler::writeTrace(string filename) const
+{
+    ofstream file(filename);
+    bool json = (filename.size() >= 5) and (filename.substr(filename.size()-5)==".json");
+
+    if (json){
+        file << "[" << endl;
+        for (int t=0; t<int(trace.size()); t++){
+            file << "  {\"step\": " << traceStep[t];
+            for (int k=0; k<N_PHASES; k++){file << ", \"" << phaseNames[k] << "\": " << trace[t][k];}
+            file << "}" << (t+1 < int(trace.size()) ? "," : "") << endl;
+        }
+        file << "]" << endl;
+    }
+    else {
+        file << "step";
+        for (int k=0; k<N_PHASES; k++){file << "," << phaseNames[k];}
+        file << endl;
+        for (int t=0; t<int(trace.size()); t++){
+            file << traceStep[t];
+            for (int k=0; k<N_PHASES; k++){file << "," << trace[t][k];}
+            file << endl;
+        }
+    }
+}
@@ -0,0 +1,189 @@
+#include <cstdio>
+#include <fstream>
+#include <atomic>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ResultCache.hpp"
+#include "Simulation.hpp"
+
+using namespace std;
+
+//Version of the file format and of the rules (part of every key : changing it invalidates the cache)
+static const uint32_t CACHE_VERSION = 3;
+
+//======================================================================
+//                          Content hash
+//======================================================================
+
+//FNV-1a hash of the bytes of the inputs (floats by their bits)
+class ContentHash
+{
+public:
+    uint64_t value = 1469598103934665603ULL;
+
+    void add(const void* data, size_t bytes){
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t b=0; b<bytes; b++){value = (value ^ p[b]) * 1099511628211ULL;}
+    }
+    void add(int x){add(&x, sizeof(x));}
+    void add(uint32_t x){add(&x, sizeof(x));}
+    void add(float x){add(&x, sizeof(x));}
+    void add(const string& s){add(int(s.size())); add(s.data(), s.size());}
+    template<typename T> void add(const vector<T>& v){add(int(v.size())); for (const T& x : v){add(x);}}
+    template<typename T, int N> void add(const SmallVecteur<T,N>& v){add(int(v.size())); for (const T& x : v){add(x);}}
+    void add(const Population& sp){add(sp.name); add(sp.niche.parameters); add(sp.diffusion_speed); add(sp.tolerance);}
+};
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+ResultCache::ResultCache(string dir) : directory(dir)
+{
+}
+
+string ResultCache::path(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+    return directory + "/" + name;
+}
+
+//Hash of the inputs of a run (the parameters only used to generate the environment are in its conditions)
+uint64_t ResultCache::key(const Environment& env, int nIter)
+{
+    ContentHash h;
+    h.add(CACHE_VERSION);
+    h.add(nIter);
+    h.add(env.m);
+    h.add(env.n);
+    h.add(env.envType);
+    h.add(env.migrationType);
+    h.add(env.selectionType);
+    h.add(env.dispersalProbability);
+    h.add(env.softmaxTemperature);
+    h.add(env.hybridProbability);
+    h.add(env.maxSpecies);
+    h.add(env.migrationMethod);
+    h.add(env.distanceThreshold);
+    h.add(env.neighbourhood);
+    h.add(env.neighbourhoodKernel);
+    h.add(env.rowBoundary);
+    h.add(env.columnBoundary);
+    h.add(env.rng.seed);
+    h.add(env.rng.replicate);
+    h.add(env.step);
+    h.add(int(env.recordInterface));
+    h.add(*env.species);
+
+    Shared<vector<VariableEnv<Conditions>>> conditions = env.conditionLayer();     //Same key in compact storage
+    h.add(int(conditions.size()));
+    for (const auto& c : conditions){h.add(c.parameters);}
+    for (const auto& scores : env.adaptationScores){h.add(scores.first); h.add(scores.second.plane());}
+    for (const auto& node : env.repartition){
+        h.add(int(node.size()));
+        for (int id : node){h.add(env.population(id).name);}       //Names : the ids depend on the order of registration
+    }
+    h.add(env.numberOfChanges);
+    return h.value;
+}
+
+//Result of a run : final environment (from the initial one), counts, stationarity and colonisation times
+bool ResultCache::load(uint64_t key, Simulation& result)
+{
+    Environment& env = result.environment;
+    int mn = env.m*env.n;
+    ifstream file(path(key), ios::binary);
+    uint64_t fileKey = 0;
+    int header[5] = {0, 0, 0, 0, 0};
+    if (!file.read((char*)&fileKey, sizeof(fileKey)) or !file.read((char*)header, sizeof(header))
+        or (fileKey!=key) or (header[0]!=env.m) or (header[1]!=env.n) or (header[2]!=int(env.species.size()))){misses += 1; return false;}
+
+    //Series of the counts of each species, of the changes and of the interface length
+    auto readSeries = [&](auto& series){
+        int length = 0;
+        file.read((char*)&length, sizeof(length));
+        if (!file or (length < 0)){return false;}
+        series.resize(length);
+        file.read((char*)series.data(), length*sizeof(series[0]));
+        return bool(file);
+    };
+    Vecteur<Vecteur<float>> countVector(env.species.size());
+    Vecteur<int> changedNodes, interfaceLength;
+    for (auto& counts : countVector){
+        if (!readSeries(counts)){misses += 1; return false;}
+    }
+    if (!readSeries(changedNodes) or !readSeries(interfaceLength)){misses += 1; return false;}
+
+    //Final state
+    vector<int> numberOfChanges(mn), colonisationTime(mn);
+    vector<vector<int>> repartition(mn);
+    for (int c=0; c<mn; c++){
+        int size = 0;
+        file.read((char*)&size, sizeof(size));
+        for (int l=0; file and (l<size); l++){
+            int k = -1;
+            file.read((char*)&k, sizeof(k));
+            if ((k < 0) or (k >= int(env.species.size()))){misses += 1; return false;}
+            repartition[c].push_back(env.species[k].id);
+        }
+    }
+    file.read((char*)numberOfChanges.data(), mn*sizeof(int));
+    file.read((char*)colonisationTime.data(), mn*sizeof(int));
+    if (!file){misses += 1; return false;}
+
+    result.timeBeforeStationarity = header[3];
+    result.countVector = countVector;
+    result.changedNodes = changedNodes;
+    result.interfaceLength = interfaceLength;
+    result.colonisationTime = colonisationTime;
+    env.repartition = repartition;
+    env.numberOfChanges = numberOfChanges;
+    env.step = header[4];
+    hits += 1;
+    return true;
+}
+
+//Save the result of a run (written in a temporary file of its own, then renamed : a cache read in parallel never
+//sees half a file, and runs of the same key written in parallel do not mix their files)
+void ResultCache::store(uint64_t key, const Simulation& result, int inputSpecies) const
+{
+    const Environment& env = result.environment;
+    int mn = env.m*env.n;
+
+    //Hybrids appeared during the run : the series do not match the species of the inputs (never read back)
+    if (int(env.species.size()) != inputSpecies){return;}
+
+    //Species of every node (a species out of the species list cannot be read back)
+    vector<int> nodes;
+    for (int c=0; c<mn; c++){
+        nodes.push_back(env.repartition[c].size());
+        for (int id : env.repartition[c]){
+            int k = env.speciesIndex(id);
+            if (k < 0){return;}
+            nodes.push_back(k);
+        }
+    }
+
+    mkdir(directory.c_str(), 0755);
+    static atomic<unsigned> written(0);
+    string temporary = path(key) + "." + to_string(getpid()) + "-" + to_string(written++) + ".tmp";
+    ofstream file(temporary, ios::binary);
+    int header[5] = {env.m, env.n, int(env.species.size()), result.timeBeforeStationarity, env.step};
+    file.write((const char*)&key, sizeof(key));
+    file.write((const char*)header, sizeof(header));
+    auto writeSeries = [&](const auto& series){
+        int length = series.size();
+        file.write((const char*)&length, sizeof(length));
+        file.write((const char*)series.data(), length*sizeof(series[0]));
+    };
+    for (const auto& counts : result.countVector){writeSeries(counts);}
+    writeSeries(result.changedNodes);
+    writeSeries(result.interfaceLength);
+    file.write((const char*)nodes.data(), nodes.size()*sizeof(int));
+    file.write((const char*)env.numberOfChanges.data(), mn*sizeof(int));
+    file.write((const char*)result.colonisationTime.data(), mn*sizeof(int));
+    file.close();
+    if (!file){remove(temporary.c_str()); return;}
+    rename(temporary.c_str(), path(key).c_str());
+}
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include "ScoreLayer.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+//Memory of the species (the levels of an image-derived environment are shared by every species)
+long ScoreLayer::bytes() const
+{
+    long total = values.size()*sizeof(float) + ranks.size()*sizeof(uint8_t);
+    if (coded){total += levels.size()*sizeof(uint16_t);}
+    return total;
+}
+
+//Same scores coded by their rank in the sorted distinct scores (8 bits if there are at most 256 of them,
+//16 bits if there are at most 65536), the layer itself if it is a table or if the ranks would not save memory
+ScoreLayer ScoreLayer::compact() const
+{
+    if ((level != nullptr) or (rank != nullptr)){return *this;}
+
+    //Distinct scores (sorted : the rank of a score is its position)
+    int mn = values.size();
+    vector<float> distinct(value, value+mn);
+    sort(distinct.begin(), distinct.end());
+    distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+    long width = (distinct.size() <= 256) ? 1 : 2;
+    if ((distinct.size() > 65536) or (distinct.size()*sizeof(float) + mn*width >= mn*sizeof(float))){return *this;}
+
+    ScoreLayer layer;
+    auto rankOf = [&](float x){return lower_bound(distinct.begin(), distinct.end(), x) - distinct.begin();};
+    if (distinct.size() <= 256){
+        vector<uint8_t>& r = layer.ranks.write();
+        r.resize(mn);
+        for (int c=0; c<mn; c++){r[c] = rankOf(value[c]);}
+    }
+    else {
+        vector<uint16_t>& r = layer.levels.write();
+        r.resize(mn);
+        for (int c=0; c<mn; c++){r[c] = rankOf(value[c]);}
+    }
+    Vecteur<float> scores(distinct.size());
+    copy(distinct.begin(), distinct.end(), scores.begin());
+    layer.values = scores;
+    layer.coded = true;
+    layer.point();
+    return layer;
+}
@@ -0,0 +1,166 @@
+#include "Simulation.hpp"
+
+using namespace std;
+
+//======================================================================
+//                           Member functions
+//======================================================================
+
+Simulation::Simulation(const Environment& env_init, int nIter, StepObserver* observer, ResultCache* cache)
+{   
+    //Initialization
+    environment = env_init;
+    timeBeforeStationarity = 0;     
+    countVector.resize(environment.species.size());
+    colonisationTime.assign(environment.m*environment.n, -1);
+    for (int c=0; c<environment.m*environment.n; c++){
+        if (environment.repartition[c].size()!=0){colonisationTime[c] = 0;}
+    }
+
+    //Run already done with the same inputs (the observer needs every iteration)
+    bool cached = (cache != nullptr) and (observer == nullptr);
+    int inputSpecies = environment.species.size();
+    uint64_t cacheKey = cached ? ResultCache::key(environment, nIter) : 0;
+    if (cached and cache->load(cacheKey, *this)){return;}
+
+    //Several processes, each one owning a band of rows
+    bool decomposed = environment.usesDomainDecomposition();
+    DomainDecomposition domains;
+    if (decomposed){domains.start(environment, environment.processes, nIter, colonisationTime);}
+
+    //Determinist run in a constant environment : only the nodes that change are updated
+    bool eventDriven = !decomposed and environment.usesEventDriven();
+    EventDriven engine;
+    if (eventDriven){engine = EventDriven(environment);}
+
+    //Otherwise on a large lattice : several iterations per cache-resident tile (the observer and the interface length
+    //need the environment after every iteration)
+    bool tiled = !eventDriven and !decomposed and environment.usesTemporalBlocking();
+    TemporalBlocking tiles;
+    if (tiled){tiles = TemporalBlocking(environment);}
+    bool everyIteration = (observer != nullptr) or environment.recordInterface;
+    int blockSteps = everyIteration ? 1 : max(1, environment.blockSteps);
+    int S = environment.species.size();
+    int blockIndex = 0;
+
+#ifdef PROFILER_ENABLED
+    //Collect the measures of the phases in this simulation
+    Profiler* previousProfiler = activeProfiler;
+    activeProfiler = &profiler;
+    profiler.newStep(0);
+#endif
+#ifdef MEMORY_TRACKING
+    MemoryRecord stepStart = memoryCheckpoint();
+#endif
+
+    //Count the populations (then updated from the nodes that change)
+    Vecteur<float> counts = environment.countPopulations();
+    auto record = [&](int changes){
+        for (int k=0; k<S; k++){countVector[k].push_back(counts[k]);}
+        changedNodes.push_back(changes);
+        if (environment.recordInterface){interfaceLength.push_back(environment.interfaceLength());}
+    };
+    record(0);
+    
+    //Observe the initial environment
+    if (observer != nullptr){(*observer)(environment, 0);}
+
+#ifdef MEMORY_TRACKING
+    memoryTrace.push_back(memorySince(stepStart));
+#endif
+
+    for (int i=1; i<nIter; i++)
+    {   
+#ifdef PROFILER_ENABLED
+        profiler.newStep(i);
+#endif
+#ifdef MEMORY_TRACKING
+        stepStart = memoryCheckpoint();
+#endif
+
+        //Number of nodes whose occupant changed
+        int changes = 0;
+
+        if (decomposed){
+            changes = domains.advance(environment, i);
+            counts = domains.counts;
+            if (everyIteration){domains.writeBack(environment);}
+        }
+
+        else if (eventDriven){
+            changes = engine.advance(environment);
+            counts = engine.counts;
+            for (int c : engine.frontier){colonisationTime[c] = i;}
+        }
+
+        else if (tiled){
+            //Next block of iterations (ends at the first iteration without change)
+            if (blockIndex == int(tiles.changes.size())){
+                tiles.advance(environment, min(blockSteps, nIter-i));
+                for (int c=0; c<environment.m*environment.n; c++){
+                    if (tiles.changedAt[c] > 0){colonisationTime[c] = i+tiles.changedAt[c]-1;}
+                }
+                if (everyIteration){tiles.writeBack(environment);}
+                blockIndex = 0;
+            }
+            for (int k=0; k<S; k++){counts[k] += tiles.deltas[blockIndex*S+k];}
+            changes = tiles.changes[blockIndex++];
+        }
+
+        else {
+            //Keep in memory the old environment
+            Environment oldEnvironment;
+            {
+                PROFILE_PHASE(STATIONARITY_PHASE);
+                oldEnvironment = environment;
+            }
+
+            //environment=selection(diffusion(environmentalChange(environment, i, a, b)));
+            environment=environment.migration().selection();
+
+            PROFILE_PHASE(STATIONARITY_PHASE);
+
+            //Hybrids that appeared at this iteration : new series (no node before)
+            for (int k=S; k<int(environment.species.size()); k++){
+                counts.push_back(0);
+                countVector.push_back(Vecteur<float>(changedNodes.size(), 0));
+            }
+            S = environment.species.size();
+
+            auto index = [&](const vector<int>& node){
+                int k = (node.size()==0) ? -1 : environment.speciesIndex(node[0]);
+                return (k < 0) ? S : k;
+            };
+            for (int c=0; c<environment.m*environment.n; c++){
+                if (oldEnvironment.repartition[c] != environment.repartition[c]){
+                    colonisationTime[c] = i;
+                    changes++;
+                    int before = index(oldEnvironment.repartition[c]);
+                    int after = index(environment.repartition[c]);
+                    if (before < S){counts[before] -= 1;}
+                    if (after < S){counts[after] += 1;}
+                }
+            }
+        }
+
+        //Populations, changes and interfaces of this iteration
+        record(changes);
+
+        //Observe the new environment
+        if (observer != nullptr){(*observer)(environment, i);}
+
+        //Check if the automaton is still avancing
+        bool stationary = (changes==0);
+#ifdef MEMORY_TRACKING
+        memoryTrace.push_back(memorySince(stepStart));
+#endif
+        if (stationary & timeBeforeStationarity==0){timeBeforeStationarity=i-1; break;}
+    }
+    if (tiled){tiles.writeBack(environment);}
+    if (decomposed){domains.finish(environment, colonisationTime);}
+    if (cached){cache->store(cacheKey, *this, inputSpecies);}
+
+#ifdef PROFILER_ENABLED
+    activeProfiler = previousProfiler;
+#endif
+}
@@ -0,0 +1,101 @@
+#include "Stencil.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Member functions
+//======================================================================
+
+Stencil::Stencil(string neighbourhood, int diffusionSpeed, int width, const Vecteur<Vecteur<int>>& kernel)
+{
+    shape = neighbourhood;
+    speed = diffusionSpeed;
+
+    //Set of offsets (ordered row-major, so without duplicates)
+    set<pair<int,int>> offsets;
+
+    if (shape=="vonNeumann"){
+        for (int k=-speed; k<=speed; k++){
+            for (int l=-(speed-abs(k)); l<=speed-abs(k); l++){offsets.insert({k,l});}
+        }
+    }
+
+    else if (shape=="moore"){
+        for (int k=-speed; k<=speed; k++){
+            for (int l=-speed; l<=speed; l++){offsets.insert({k,l});}
+        }
+    }
+
+    else if (shape=="custom"){
+        //Offsets of the kernel
+        int R = kernel.size()/2;
+        set<pair<int,int>> base;
+        for (int k=0; k<int(kernel.size()); k++){
+            for (int l=0; l<int(kernel[k].size()); l++){
+                if (kernel[k][l]!=0){base.insert({k-R, l-R});}
+            }
+        }
+
+        //Dilation of the kernel (speed times)
+        offsets.insert({0,0});
+        for (int s=0; s<speed; s++){
+            set<pair<int,int>> dilated(offsets);
+            for (auto& o : offsets){
+                for (auto& b : base){dilated.insert({o.first+b.first, o.second+b.second});}
+            }
+            offsets = dilated;
+        }
+    }
+
+    else {
+        cout << "unknown neighbourhood " << shape << "\n";
+        exit(1);
+    }
+
+    radius = 0;
+    for (auto& o : offsets){
+        di.push_back(o.first);
+        dj.push_back(o.second);
+        radius = max(radius, max(abs(o.first), abs(o.second)));
+    }
+    setWidth(width);
+}
+
+//Flat offsets for a (padded) lattice with width columns
+void Stencil::setWidth(int width)
+{
+    flat.resize(di.size());
+    for (int k=0; k<int(di.size()); k++){flat[k] = di[k]*width+dj[k];}
+}
+
+//======================================================================
+//                         External functions
+//======================================================================
+
+//Index in [0,size) of the coordinate x according to the boundary condition (-1 if x is outside an open lattice)
+int boundaryIndex(int x, int size, const string& boundary)
+{
+    if ((x >= 0) and (x < size)){return x;}
+    if (boundary=="periodic"){return ((x % size) + size) % size;}
+    if (boundary=="reflective"){
+        int y = ((x % (2*size)) + 2*size) % (2*size);
+        return (y < size) ? y : 2*size-1-y;
+    }
+    return -1;
+}
+
+//Map of a lattice padded with a halo (rowHalo rows and colHalo columns on each side) to the nodes of the m*n lattice.
+//A halo node outside an open boundary is mapped to the sink index m*n.
+vector<int> haloMap(int m, int n, int rowHalo, int colHalo, const string& rowBoundary, const string& columnBoundary)
+{
+    int width = n+2*colHalo;
+    vector<int> fold((m+2*rowHalo)*width);
+    for (int pi=0; pi<m+2*rowHalo; pi++){
+        int i = boundaryIndex(pi-rowHalo, m, rowBoundary);
+        for (int pj=0; pj<width; pj++){
+            int j = boundaryIndex(pj-colHalo, n, columnBoundary);
+            fold[pi*width+pj] = ((i < 0) or (j < 0)) ? m*n : i*n+j;
+        }
+    }
+    return fold;
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <map>
+#include <utility>
+#include "TemporalBlocking.hpp"
+#include "Functor.hpp"
+#include "Profiler.hpp"
+
+using namespace std;
+
+//======================================================================
+//                        TileKernel functions
+//======================================================================
+
+void TileWindow::resize(int wm, int wn, int S)
+{
+    rows = wm;
+    columns = wn;
+    node.resize(wm*wn);
+    occ.resize(wm*wn);
+    chg.resize(wm*wn);
+    newOcc.resize(wm*wn);
+    newChg.resize(wm*wn);
+    last.assign(wm*wn, 0);
+    score.resize(wm*wn*S);
+    candidateMask.assign((S+63)/64, 0);
+}
+
+TileKernel::TileKernel(const Environment& env)
+{
+    int S = env.species.size();
+
+    //Union of the stencils : species reaching a node along each offset
+    map<pair<int,int>, vector<char>> offsets;
+    for (int k=0; k<S; k++){
+        const Stencil& st = env.stencils.at(env.species[k].diffusion_speed);
+        radius = max(radius, st.radius);
+        for (int o=0; o<st.size(); o++){
+            vector<char>& r = offsets[{st.di[o], st.dj[o]}];
+            r.resize(S, 0);
+            r[k] = 1;
+        }
+    }
+
+    //Decreasing offsets : the sources (node - offset) of a node come in row-major order
+    for (auto it=offsets.rbegin(); it!=offsets.rend(); it++){
+        di.push_back(it->first.first);
+        dj.push_back(it->first.second);
+        reaches.insert(reaches.end(), it->second.begin(), it->second.end());
+    }
+}
+
+//steps iterations of a loaded window : tile of th x tw nodes with a halo of steps*radius nodes on each side.
+//stepChanges counts the nodes of the tile that changed at each iteration, stepDeltas (if given) the nodes
+//gained by each species at each iteration (index s*S+k).
+void TileKernel::advance(const Environment& env, int steps, TileWindow& w, int th, int tw, int* stepChanges, int* stepDeltas) const
+{
+    int S = env.species.size();
+    int H = steps*radius;
+    int wm = w.rows;
+    int wn = w.columns;
+    bool stochastic = (env.migrationType=="stochastic");
+
+    w.flat.resize(di.size());
+    for (int u=0; u<int(di.size()); u++){w.flat[u] = di[u]*wn+dj[u];}
+
+    for (int s=0; s<steps; s++){
+        int step = env.step+s;
+        int shrink = (s+1)*radius;
+
+        //Migration and selection of the nodes whose sources are all up to date
+        for (int a=shrink; a<wm-shrink; a++){
+            for (int b=shrink; b<wn-shrink; b++){
+                int p = a*wn+b;
+                int target = w.node[p];
+                w.newOcc[p] = w.occ[p];
+                w.newChg[p] = w.chg[p];
+                if (target < 0){continue;}
+
+                //Arrivals of the species using the stencils
+                w.arrivals.clear();
+                for (int u=0; u<int(w.flat.size()); u++){
+                    int q = p-w.flat[u];
+                    int k = w.occ[q];
+                    if ((k < 0) or !reaches[u*S+k]){continue;}
+                    if (stochastic and !env.rng.bernoulli(env.dispersalProbability, MIGRATION, step, w.node[q], target)){continue;}
+                    w.arrivals.push_back({w.node[q], k});
+                }
+                if (w.sortSources){sort(w.arrivals.begin(), w.arrivals.end());}
+
+                //Candidates : occupant, then arrivals (each species once, at its first arrival, as in Environment::migration)
+                w.candidates.clear();
+                auto candidate = [&](int k){
+                    uint64_t bit = uint64_t(1) << (k&63);
+                    if (!(w.candidateMask[k>>6] & bit)){w.candidateMask[k>>6] |= bit; w.candidates.push_back(k);}
+                };
+                if (w.occ[p] >= 0){candidate(w.occ[p]);}
+                for (auto& arrival : w.arrivals){candidate(arrival.second);}
+                for (int k : w.candidates){w.candidateMask[k>>6] = 0;}
+                if (w.candidates.size()==0){continue;}
+
+                w.candidateScores.resize(w.candidates.size());
+                for (int k=0; k<int(w.candidates.size()); k++){w.candidateScores[k] = w.score[p*S+w.candidates[k]];}
+                int winner = w.candidates[env.chooseCandidate(w.candidates, w.candidateScores, target, step)];
+
+                w.newOcc[p] = winner;
+                if (winner != w.candidates[0]){w.newChg[p] += 1;}
+                if (winner != w.occ[p]){
+                    w.last[p] = s+1;
+                    if ((a >= H) and (a < H+th) and (b >= H) and (b < H+tw)){
+                        stepChanges[s]++;
+                        if (stepDeltas != nullptr){
+                            if (w.occ[p] >= 0){stepDeltas[s*S+w.occ[p]]--;}
+                            stepDeltas[s*S+winner]++;
+                        }
+                    }
+                }
+            }
+        }
+        w.occ.swap(w.newOcc);
+        w.chg.swap(w.newChg);
+    }
+}
+
+//======================================================================
+//                     TemporalBlocking functions
+//======================================================================
+
+TemporalBlocking::TemporalBlocking(const Environment& env) : tileSize(env.tileSize), kernel(env)
+{
+    int S = env.species.size();
+    int mn = env.m*env.n;
+
+    //Scores of every species (the conditions do not change during a Simulation)
+    scores.resize(S*mn);
+    for (int k=0; k<S; k++){
+        Vecteur<float> grid;
+        if (env.envType=="constant"){grid = env.adaptationScores.at(env.species[k].name).plane();}
+        else {grid = env.scoreLayer(env.species[k]).plane();}
+        copy(grid.begin(), grid.end(), scores.begin()+k*mn);
+    }
+
+    occupant.assign(mn, -1);
+    for (int c=0; c<mn; c++){
+        if (env.repartition[c].size()!=0){
+            occupant[c] = env.speciesIndex(env.repartition[c][0]);
+        }
+    }
+    changedAt.assign(mn, 0);
+}
+
+//Up to steps iterations of the whole lattice, stopping after the first one without change (as a Simulation does)
+int TemporalBlocking::advance(Environment& env, int steps)
+{
+    PROFILE_PHASE(TILED_PHASE);
+
+    block(env, steps, nextOccupant, nextChanges);
+
+    //An iteration without change ends the run : the block is done again up to this iteration
+    int done = find(changes.begin(), changes.end(), 0) - changes.begin() + 1;
+    if (done < steps){block(env, done, nextOccupant, nextChanges);}
+    else {done = steps;}
+
+    occupant.swap(nextOccupant);
+    env.numberOfChanges.swap(nextChanges);
+    env.step += done;
+    return done;
+}
+
+//Repartition of the environment from the occupants (only the nodes that changed are written)
+void TemporalBlocking::writeBack(Environment& env) const
+{
+    for (int c=0; c<env.m*env.n; c++){
+        if (occupant[c] < 0){env.repartition[c].clear();}
+        else if ((env.repartition[c].size()!=1) or (env.repartition[c][0]!=env.species[occupant[c]].id)){
+            env.repartition[c] = vector<int>({env.species[occupant[c]].id});
+        }
+    }
+}
+
+//steps iterations of every tile, from the occupants and numbers of changes of the environment
+void TemporalBlocking::block(const Environment& env, int steps, vector<int>& nextOccupant, vector<int>& nextChanges)
+{
+    int mn = env.m*env.n;
+    int tileColumns = (env.n+tileSize-1)/tileSize;
+    int nTiles = ((env.m+tileSize-1)/tileSize)*tileColumns;
+
+    nextOccupant.resize(mn);
+    nextChanges.resize(mn);
+    changes.assign(steps, 0);
+    deltas.assign(steps*env.species.size(), 0);
+
+    #pragma omp parallel
+    {
+        TileWindow w;
+        vector<int> tileChanges(steps, 0);
+        vector<int> tileDeltas(steps*env.species.size(), 0);
+
+        #pragma omp for schedule(dynamic)
+        for (int t=0; t<nTiles; t++){
+            int r0 = (t/tileColumns)*tileSize;
+            int c0 = (t%tileColumns)*tileSize;
+            tile(env, steps, r0, min(tileSize, env.m-r0), c0, occupant.data(), env.numberOfChanges.data(),
+                 nextOccupant.data(), nextChanges.data(), changedAt.data(), tileChanges.data(), tileDeltas.data(), w);
+        }
+
+        #pragma omp critical
+        {
+            for (int s=0; s<steps; s++){changes[s] += tileChanges[s];}
+            for (int u=0; u<int(tileDeltas.size()); u++){deltas[u] += tileDeltas[u];}
+        }
+    }
+}
+
+//steps iterations of the rows [rowBegin,rowEnd) from the occupants and numbers of changes of the whole lattice
+//(one thread, used by the processes of a DomainDecomposition). stepChanges and stepDeltas count the changes of these rows only.
+void TemporalBlocking::advanceRows(const Environment& env, int steps, int rowBegin, int rowEnd, const int* occupantIn, const int* changesIn,
+                                   int* occupantOut, int* changesOut, int* changedAtOut, int* stepChanges, int* stepDeltas) const
+{
+    TileWindow w;
+    fill(stepChanges, stepChanges+steps, 0);
+    fill(stepDeltas, stepDeltas+steps*env.species.size(), 0);
+    for (int r0=rowBegin; r0<rowEnd; r0+=tileSize){
+        for (int c0=0; c0<env.n; c0+=tileSize){
+            tile(env, steps, r0, min(tileSize, rowEnd-r0), c0, occupantIn, changesIn, occupantOut, changesOut, changedAtOut, stepChanges, stepDeltas, w);
+        }
+    }
+}
+
+//steps iterations of the tile of th rows from (r0,c0) : loaded with its halo, advanced in cache, written back
+void TemporalBlocking::tile(const Environment& env, int steps, int r0, int th, int c0, const int* occupantIn, const int* changesIn,
+                            int* occupantOut, int* changesOut, int* changedAtOut, int* stepChanges, int* stepDeltas, TileWindow& w) const
+{
+    int m = env.m;
+    int n = env.n;
+    int mn = m*n;
+    int S = env.species.size();
+    int H = steps*kernel.radius;
+    int tw = min(tileSize, n-c0);
+    int wm = th+2*H;
+    int wn = tw+2*H;
+
+    //Load the tile and its halo : images of the nodes across a periodic or reflective boundary, -1 outside an open one
+    w.resize(wm, wn, S);
+    for (int a=0; a<wm; a++){
+        int i = boundaryIndex(r0-H+a, m, env.rowBoundary);
+        for (int b=0; b<wn; b++){
+            int j = boundaryIndex(c0-H+b, n, env.columnBoundary);
+            int p = a*wn+b;
+            int c = ((i < 0) or (j < 0)) ? -1 : i*n+j;
+            w.node[p] = c;
+            w.occ[p] = (c < 0) ? -1 : occupantIn[c];
+            w.chg[p] = (c < 0) ? 0 : changesIn[c];
+            if (c >= 0){
+                for (int k=0; k<S; k++){w.score[p*S+k] = scores[k*mn+c];}
+            }
+        }
+    }
+    w.sortSources = ((env.rowBoundary!="open") and ((r0-H < 0) or (r0+th+H > m)))
+                    or ((env.columnBoundary!="open") and ((c0-H < 0) or (c0+tw+H > n)));
+
+    kernel.advance(env, steps, w, th, tw, stepChanges, stepDeltas);
+
+    //Write back the tile
+    for (int a=H; a<H+th; a++){
+        for (int b=H; b<H+tw; b++){
+            int p = a*wn+b;
+            occupantOut[w.node[p]] = w.occ[p];
+            changesOut[w.node[p]] = w.chg[p];
+            changedAtOut[w.node[p]] = w.last[p];
+        }
+    }
+}
@@ -7,10 +7,17 @@
 #include "Population.hpp"
 #include "Environment.hpp"
 #include "Simulation.hpp"
+#include "Ensemble.hpp"
+#include "OutOfCore.hpp"
 #include "Functor.hpp"
+#ifndef HEADLESS
+#include "Display.hpp"
+#endif
+#ifdef WITH_MATPLOTLIB
 #include "matplotlibcpp.h"
 
 namespace plt = matplotlibcpp;
+#endif
 
 int main(int argc, char *argv[])
 {
@@ -24,31 +31,56 @@ int main(int argc, char *argv[])
     // 
     // We use two data images, containing the depth in meters and vegetation cover importance value index (IVI).
     //
+    // Usage : main [--no-plot] [--iterations N] [--cache DIR]
+    //   --no-plot      run without writing the images (training run of 'make pgo')
+    //   --iterations   number of iterations of the simulation (default 400)
+    //   --cache        read the results of the runs already done from DIR (runs without images only)
+    //
+    // A headless build (make HEADLESS=1) only links the simulation core, without the
+    // rendering add-on to read the images : the lattice keeps the size of the images
+    // but the environment is a percolation pattern.
+    //
     //===========================================================================
     //                          Load environmental image
     //                 (Carefull with image sizes, they need to match)
     //===========================================================================
 
-    sf::Image depthImage;
-    sf::Image vegetationImage;
-    depthImage.loadFromFile("include/roscoff_rocky_beach_resized_full_sea.png");
-    vegetationImage.loadFromFile("include/vegetation_cover_1.png");
-    sf::Vector2u sizeDepth = depthImage.getSize();
-    sf::Vector2u sizeVeg = vegetationImage.getSize();
-    if(sizeDepth.x != sizeVeg.x | sizeDepth.y != sizeVeg.y){cout << "image size don't match \n"; exit(1);} //Check before if the two images have the same size
+#ifndef HEADLESS
+    Raster depthImage = loadRaster("include/roscoff_rocky_beach_resized_full_sea.png");
+    Raster vegetationImage = loadRaster("include/vegetation_cover_1.png");
+    if(depthImage.width != vegetationImage.width | depthImage.height != vegetationImage.height){cout << "image size don't match \n"; exit(1);} //Check before if the two images have the same size
+#endif
 
     //===========================================================================
     //                          Define model parameters
     //===========================================================================
 
     map<string, float> parameters;
-    parameters["n"] = sizeDepth.x;              //Number of columns of the lattice
-    parameters["m"] = sizeDepth.y;              //Number of rows of the lattice
+#ifndef HEADLESS
+    parameters["n"] = depthImage.width;         //Number of columns of the lattice
+    parameters["m"] = depthImage.height;        //Number of rows of the lattice
+#else
+    parameters["n"] = 271;                      //Number of columns of the lattice (size of the images)
+    parameters["m"] = 259;                      //Number of rows of the lattice
+    parameters["percolationProbability"] = 0.6;
+#endif
     int nIter =400;                             //Number of iteration in the simulation
     bool plot = true;                           //Plot the results
     string envGeneration = "percolation";       //Method to generate the environnement : "normal", "function", "percolation" (Not used when using images)
     string initialRepartition = "pointStart";   //Method to initialize the species repartition : "bottomStart", "oppositeCornerStart", "pointStart", "centralStart"
     string envType = "constant";                //Type of the environment : "constant", "variable"
+    string cacheDirectory = "";                 //Directory of the result cache (no cache if empty)
+
+    //Command line options
+    for (int k=1; k<argc; k++){
+        string arg = argv[k];
+        if (arg=="--no-plot"){plot = false;}
+        else if ((arg=="--iterations") and (k+1<argc)){nIter = atoi(argv[++k]);}
+        else if ((arg=="--cache") and (k+1<argc)){cacheDirectory = argv[++k];}
+    }
+
+    //Seed of the counter-based random generator (same seed => same run, whatever the number of threads)
+    //parameters["seed"] = 1;
 
     //Probability of open/close, to use when environnement is a percolation pattern 
     //parameters["percolationProbability"] = 0.1;
@@ -57,6 +89,14 @@ int main(int argc, char *argv[])
     //parameters["distMean"] = 0.5;             //Mean of species niche, mean of the distribution used for environment generation
     //parameters["distVar"] = 0.5;              //Variance of the distribution used for environment generation
     
+    //Parameters of the stochastic rules (see migrationType and selectionType below)
+    //parameters["dispersalProbability"] = 0.5; //Probability to colonise each neighbour
+    //parameters["softmaxTemperature"] = 0.1;   //Temperature of the softmax competition
+    //parameters["hybridProbability"] = 0.1;    //Probability that two species meeting in a node give their hybrid
+
+    //parameters["distanceThreshold"] = 4;       //Smallest diffusion speed migrating with the minimum filter (migrationMethod "auto")
+    //parameters["compactStorage"] = 1;          //Score layers stored as ranks, conditions of the images and percolations stored as levels
+
     //Parameters when environnement is made with functions
     //parameters["unit"] = 0.1;                 //Unit of a square
     //parameters["envDilatation"] = 5;          //Oscillation parameter
@@ -67,30 +107,40 @@ int main(int argc, char *argv[])
     //===========================================================================
 
     //Make population' niches
-    VariableEnv<Vecteur<float>> niche_A(Vecteur<float>({7, 3}));        //Perforatus optimum
-    VariableEnv<Vecteur<float>> niche_B(Vecteur<float>({1, 5}));        //Chthamalus optimum
-    VariableEnv<Vecteur<float>> niche_C(Vecteur<float>({0, 5}));        //Mask optimum
-
-    Vecteur<Vecteur<float>> tol_A({Vecteur<float>({3, 4}), Vecteur<float>({4, 8})});       //Perforatus tolerance
-    Vecteur<Vecteur<float>> tol_B({Vecteur<float>({6, 0}), Vecteur<float>({0, 100})});     //Chthamalus tolerance
-    Vecteur<Vecteur<float>> tol_C({Vecteur<float>({0.01, 0}), Vecteur<float>({0, 100})});  //Mask tolerance
+#ifndef HEADLESS
+    VariableEnv<Conditions> niche_A(Conditions({7, 3}));        //Perforatus optimum
+    VariableEnv<Conditions> niche_B(Conditions({1, 5}));        //Chthamalus optimum
+    VariableEnv<Conditions> niche_C(Conditions({0, 5}));        //Mask optimum
+
+    Tolerance tol_A({Conditions({3, 4}), Conditions({4, 8})});       //Perforatus tolerance
+    Tolerance tol_B({Conditions({6, 0}), Conditions({0, 100})});     //Chthamalus tolerance
+    Tolerance tol_C({Conditions({0.01, 0}), Conditions({0, 100})});  //Mask tolerance
+#else
+    VariableEnv<Conditions> niche_A(Conditions({7})); 
+    VariableEnv<Conditions> niche_B(Conditions({3}));
+    VariableEnv<Conditions> niche_C(Conditions({0}));
+
+    Tolerance tol_A({Conditions({3})});
+    Tolerance tol_B({Conditions({4.5})});
+    Tolerance tol_C({Conditions({0.1})});
+#endif
 
     /*
-    VariableEnv<Vecteur<float>> niche_A(Vecteur<float>({7})); 
-    VariableEnv<Vecteur<float>> niche_B(Vecteur<float>({3}));
-    VariableEnv<Vecteur<float>> niche_C(Vecteur<float>({0}));
+    VariableEnv<Conditions> niche_A(Conditions({7})); 
+    VariableEnv<Conditions> niche_B(Conditions({3}));
+    VariableEnv<Conditions> niche_C(Conditions({0}));
 
-    Vecteur<Vecteur<float>> tol_A({Vecteur<float>({3})});
-    Vecteur<Vecteur<float>> tol_B({Vecteur<float>({4.5})});
-    Vecteur<Vecteur<float>> tol_C({Vecteur<float>({0.1})});
+    Tolerance tol_A({Conditions({3})});
+    Tolerance tol_B({Conditions({4.5})});
+    Tolerance tol_C({Conditions({0.1})});
     */
 
     /*
-    VariableEnv<Vecteur<float>> niche_A(Vecteur<float>({0}));
-    VariableEnv<Vecteur<float>> niche_B(Vecteur<float>({1}));
+    VariableEnv<Conditions> niche_A(Conditions({0}));
+    VariableEnv<Conditions> niche_B(Conditions({1}));
 
-    Vecteur<Vecteur<float>> tol_A({Vecteur<float>({1})});
-    Vecteur<Vecteur<float>> tol_B({Vecteur<float>({1})});
+    Tolerance tol_A({Conditions({1})});
+    Tolerance tol_B({Conditions({1})});
     */
 
     //Creation of the species
@@ -109,20 +159,63 @@ int main(int argc, char *argv[])
     string filename="heterogenous=bloscon \n "+envType+"\n ";
 
     //Construction of the environnement
+#ifndef HEADLESS
     Environment E(depthImage, vegetationImage, spVector, parameters, filename, initialRepartition, envType);         //Env from two images and functors
+#else
+    Environment E(spVector, parameters, filename, envGeneration, initialRepartition, envType);                      //No image reader without SFML
+#endif
     //Environment E(spVector, parameters, filename, envGeneration, initialRepartition, envType);                     //Env from functors only
     //Environment E(depthImage, spVector, parameters, filename, initialRepartition, envType);                        //Env from an image and functors
+    //Environment E2(E, spVector, parameters, filename, initialRepartition);                                          //Other run on the same site (conditions and scores shared with E)
+
+    //Rules of the automaton
+    E.migrationType = "determinist";            //Type of migration : "determinist", "stochastic"
+    E.selectionType = "determinist";            //Type of selection : "determinist", "proportional", "softmax"
+    E.migrationMethod = "auto";                 //Reach computation : "stencil", "distance" (linear-time minimum filter for large speeds), "auto"
+    E.rowBoundary = "open";                     //Boundary condition of the rows : "open", "periodic", "reflective"
+    E.columnBoundary = "open";                  //Boundary condition of the columns : "open", "periodic", "reflective"
+    E.solver = "auto";                          //Engine : "auto", "iterative", "tiled" (several iterations per cache-resident tile)
+    //E.blockSteps = 4;                         //Iterations per tile of the "tiled" solver
+    //E.processes = 4;                          //Cooperating processes, each one owning a band of rows (domain decomposition)
+    //E.recordInterface = true;                 //Record the interface length at every iteration (automate.interfaceLength)
+    //E.setNeighbourhood("moore");              //Neighbourhood of the migration : "vonNeumann" (default), "moore", "custom" (with a 0/1 kernel)
 
     //===========================================================================
     //                              Run simulation
     //===========================================================================
     
-    Simulation automate(E, nIter, plot);
+    //Images written at every iteration by the rendering add-on
+    StepObserver* observer = nullptr;
+#ifndef HEADLESS
+    ImageObserver images;
+    if (plot==true){observer = &images;}
+#else
+    if (plot==true){cout << "no images in a headless build \n";}
+#endif
+
+    ResultCache cache(cacheDirectory.empty() ? "output/cache" : cacheDirectory);
+    Simulation automate(E, nIter, observer, cacheDirectory.empty() ? nullptr : &cache);
+
+#ifdef PROFILER_ENABLED
+    //Time (and allocations) spent in each phase (make PROFILE=1 and/or MEMORY=1)
+    automate.profiler.report(cout);
+    automate.profiler.writeTrace("output/profile.csv");
+#endif
+
+#ifdef MEMORY_TRACKING
+    //Heap allocations of each iteration and peak resident memory of the run (make MEMORY=1)
+    for (int i=0; i<int(automate.memoryTrace.size()); i++){
+        cout << "t=" << i << " allocations=" << automate.memoryTrace[i].allocations << " bytes=" << automate.memoryTrace[i].bytes 
+             << " peakLiveBytes=" << automate.memoryTrace[i].peakLiveBytes << endl;
+    }
+    cout << "peakResidentKB=" << peakResidentMemory() << endl;
+#endif
 
     //===========================================================================
     //                                  Display
     //===========================================================================  
     
+    //The plots need matplotlib-cpp and Python (make PLOT=1)
     /*
     Vecteur<float> t; for (int i=0; i<automate.timeBeforeStationarity+2; i++){t.push_back(i);}    
     plt::plot(t, automate.countVector[0]/(parameters["m"]*parameters["n"]));
@@ -142,7 +235,7 @@ int main(int argc, char *argv[])
     Vecteur<int> repartitionLabeled({});
     for (int i=0; i<parameters["n"]; i++)
     {
-        if (automate.environment.repartition[i][0].name=="A"){repartitionLabeled.push_back(labels[0]);}
+        if (automate.environment.population(automate.environment.repartition[i][0]).name=="A"){repartitionLabeled.push_back(labels[0]);}
         else {repartitionLabeled.push_back(labels[1]);}
     }
 
@@ -154,6 +247,32 @@ int main(int argc, char *argv[])
     plt::clf();
     */
 
+    /*
+    //Percolation threshold : 64 replicates of each probability advanced together (bit-sliced ensemble, Ensemble.hpp)
+    for (float p : {0.5f, 0.55f, 0.59f, 0.6f, 0.65f}){
+        vector<Environment> replicates;
+        for (int l=0; l<64; l++){
+            map<string, float> param(parameters);
+            param["percolationProbability"] = p;
+            param["seed"] = 1;
+            param["replicate"] = l;
+            replicates.push_back(Environment(spVector, param, filename, "percolation", "pointStart", "constant"));
+        }
+        Ensemble ensemble(replicates, nIter);
+        cout << "p=" << p << " stationarity times: " << ensemble.timeBeforeStationarity;
+    }
+    */
+
+    /*
+    //Map larger than the memory : layers in memory-mapped tile files, only the tiles of the invasion front advance (OutOfCore.hpp)
+    OutOfCore region(spVector, parameters, "output/tiles", 256);
+    envFunctor fromImages;
+    region.setConditions([&](int i, int j){return fromImages(i, j, depthImage, vegetationImage);});
+    region.setOccupant(parameters["m"]-1, parameters["n"]/2, 0);
+    region.run(nIter);
+    cout << "stationarity time: " << region.timeBeforeStationarity << " populations: " << region.counts << endl;
+    */
+
     /*
     //Input
     int nReplicate = 10;
@@ -189,6 +308,8 @@ int main(int argc, char *argv[])
                     param["n"] = parameters["n"];
                     param["m"] = parameters["m"];
                     param["percolationProbability"] = means[i];
+                    param["seed"] = 1;                      //One seed for the whole sweep
+                    param["replicate"] = l;                 //Each replicate has its own random stream
                     //param["distMean"] =  means[i];
                     //param["distVar"] = variances[j];
                     //param["persistency"] = persistencies[k];
@@ -197,7 +318,7 @@ int main(int argc, char *argv[])
                     Environment E(spVector, param, filename, "percolation", "pointStart");
 
                     //Run simulation
-                    Simulation automate(E, nIter, plot);
+                    Simulation automate(E, nIter, nullptr, &cache);
 
                     //Plot the final repartition
                     tuple<sf::Uint8*, string, string, sf::Color, sf::Color> rep = repartitionToPixel(automate.environment);
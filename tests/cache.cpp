@@ -0,0 +1,74 @@
+#include <iostream>
+#include <filesystem>
+#include "lattice.hpp"
+#include "Simulation.hpp"
+#include "ResultCache.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Regression check of the result cache (ResultCache.hpp).
+//
+// For determinist and stochastic rules, a Simulation given an empty cache runs and
+// stores its result. The same Simulation run again must be read from the cache (a hit)
+// and give the final repartition, numbers of changes, counts, colonisation times, time
+// before stationarity and step of the run.
+//
+//======================================================================
+
+//Environment of the check : three species from opposite corners and the centre of a random environment
+Environment inputs(string migration, string selection)
+{
+    Environment E = lattice("cache", 21, 17, {1, 2, 1});
+    E.repartition[(E.m/2)*E.n+E.n/2] = vector<int>({E.species[2].id});
+
+    E.migrationType = migration;
+    E.selectionType = selection;
+    E.dispersalProbability = 0.6;
+    return E;
+}
+
+int main()
+{
+    int failures = 0;
+    int nIter = 30;
+    string directory = (filesystem::temp_directory_path() / "check-cache").string();
+    filesystem::remove_all(directory);
+    ResultCache cache(directory);
+
+    vector<pair<string,string>> rules = {{"determinist", "determinist"}, {"stochastic", "proportional"}, {"determinist", "softmax"}};
+    for (auto& rule : rules){
+        string name = rule.first+"/"+rule.second;
+        Environment E = inputs(rule.first, rule.second);
+
+        int hits = cache.hits;
+        Simulation stored(E, nIter, nullptr, &cache);
+        if (cache.hits != hits){
+            cout << "FAIL " << name << " : read from an empty cache\n";
+            failures++;
+        }
+
+        Simulation loaded(E, nIter, nullptr, &cache);
+        if (cache.hits != hits+1){
+            cout << "FAIL " << name << " : not read from the cache\n";
+            failures++;
+        }
+        else if ((loaded.environment.repartition != stored.environment.repartition)
+            or (loaded.environment.numberOfChanges != stored.environment.numberOfChanges)
+            or (loaded.countVector != stored.countVector)
+            or (loaded.colonisationTime != stored.colonisationTime)
+            or (loaded.timeBeforeStationarity != stored.timeBeforeStationarity)
+            or (loaded.environment.step != stored.environment.step)){
+            cout << "FAIL " << name << " : result read from the cache\n";
+            failures++;
+        }
+        cout << "checked " << name << "\n";
+    }
+    filesystem::remove_all(directory);
+
+    cout << ((failures==0) ? "cache : ok" : "cache : FAILED") << "\n";
+    return (failures==0) ? 0 : 1;
+}
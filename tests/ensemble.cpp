@@ -0,0 +1,75 @@
+#include <iostream>
+#include "lattice.hpp"
+#include "Simulation.hpp"
+#include "Ensemble.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Regression check of the bit-sliced ensemble (Ensemble.hpp).
+//
+// 66 replicates (two batches, the second one partial) of species of diffusion speed
+// 1, 4 and 2 filled at random on a lattice, two of them with the same niche so the
+// selection meets ties. For every neighbourhood, boundaries and reach computation,
+// the final repartition (writeBack), the time before stationarity and the final
+// counts of every replicate must be the ones of its own iterative Simulation.
+//
+//======================================================================
+
+//Replicate r of the check : the nodes of the environment filled at random with the species (one node in 4 holds a species)
+Environment replicate(const Environment& base, int r)
+{
+    Environment E(base);
+    for (int c=0; c<E.m*E.n; c++){
+        int draw = E.rng.uniformInt(0, 11, INITIAL_REPARTITION, r+1, c);
+        if (draw < 3){E.repartition[c] = vector<int>({E.species[draw].id});}
+        else {E.repartition[c].clear();}
+    }
+    return E;
+}
+
+int main()
+{
+    int failures = 0;
+    int replicates = 66;
+    int nIter = 60;
+    vector<pair<string,string>> boundaries = {{"open", "open"}, {"periodic", "reflective"}};
+
+    for (string neighbourhood : {"vonNeumann", "moore"}){
+        for (auto& boundary : boundaries){
+            for (string method : {"stencil", "distance"}){
+                string name = neighbourhood+" "+boundary.first+"/"+boundary.second+" "+method;
+
+                Environment base = lattice("ensemble", 12, 14, {1, 4, 2}, true);
+                base.migrationMethod = method;
+                base.solver = "iterative";
+                base.rowBoundary = boundary.first;
+                base.columnBoundary = boundary.second;
+                base.setNeighbourhood(neighbourhood);
+
+                vector<Environment> envs;
+                for (int r=0; r<replicates; r++){envs.push_back(replicate(base, r));}
+                Ensemble ensemble(envs, nIter);
+
+                for (int r=0; r<replicates; r++){
+                    Simulation expected(envs[r], nIter);
+                    Environment final(envs[r]);
+                    ensemble.writeBack(final, r);
+                    if ((final.repartition != expected.environment.repartition)
+                        or (ensemble.timeBeforeStationarity[r] != expected.timeBeforeStationarity)
+                        or (ensemble.counts[r] != expected.environment.countPopulations())){
+                        cout << "FAIL " << name << " : replicate " << r << "\n";
+                        failures++;
+                    }
+                }
+                cout << "checked " << name << "\n";
+            }
+        }
+    }
+
+    cout << ((failures==0) ? "ensemble : ok" : "ensemble : FAILED") << "\n";
+    return (failures==0) ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#ifndef DEF_LATTICE_HPP
+#define DEF_LATTICE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include "Environment.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Environment shared by the regression checks of tests/.
+//
+// A constant environment of m x n nodes with three random conditions ("normal"
+// generation) and the species A, B and C of the given diffusion speeds, starting
+// from opposite corners. C has the niche of B if sameNiche (ties of the selection),
+// a niche of its own otherwise.
+//
+//======================================================================
+
+Environment lattice(string name, int m, int n, vector<int> speeds, bool sameNiche = false)
+{
+    Tolerance tolerance(3, Conditions(3, 0.f));
+    for (int k=0; k<3; k++){tolerance[k][k] = 0.5f;}
+    VariableEnv<Conditions> nicheA(Conditions({0.3f, 0.6f, 0.2f}));
+    VariableEnv<Conditions> nicheB(Conditions({0.6f, 0.4f, 0.5f}));
+    VariableEnv<Conditions> nicheC(sameNiche ? nicheB.parameters : Conditions({0.5f, 0.5f, 0.8f}));
+    Population A(nicheA, "A", speeds[0], tolerance);
+    Population B(nicheB, "B", speeds[1], tolerance);
+    Population C(nicheC, "C", speeds[2], tolerance);
+
+    map<string,float> parameters;
+    parameters["m"] = m;
+    parameters["n"] = n;
+    parameters["distMean"] = 0.5;
+    parameters["distVar"] = 0.2;
+    parameters["unit"] = 0.1;
+    parameters["envDilatation"] = 1;
+    parameters["envDelay"] = 0;
+    return Environment(vector<Population>({A, B, C}), parameters, name, "normal", "oppositeCornerStart", "constant");
+}
+
+#endif
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <algorithm>
+#include "lattice.hpp"
+#include "Simulation.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Regression check of the reach computations of the migration (Environment::migrationMethod).
+//
+// The species of diffusion speed 1, 3 and 5 share a lattice filled at random, two of them
+// with the same niche so the selection meets ties. For every neighbourhood, boundaries and
+// selection type, the candidates of the migration must be the same, in the order of their
+// first arrival, with the stencils ("stencil"), the minimum filter ("distance") and both
+// ("auto"), and so must the Simulations of every solver.
+//
+//======================================================================
+
+//Environment of the check, the nodes filled at random with the species (a node in spacing holds a species), or
+//the species alone in three corners (spacing 0)
+Environment filled(string neighbourhood, string rowBoundary, string columnBoundary, string selection, string method, string solver, int spacing = 3)
+{
+    Environment E = lattice("migration", 23, 31, {1, 3, 5}, true);
+    for (int c=0; c<E.m*E.n; c++){
+        int draw = (spacing > 0) ? E.rng.uniformInt(0, 3*spacing-1, INITIAL_REPARTITION, 1, c) : 3;
+        if (draw < 3){E.repartition[c] = vector<int>({E.species[draw].id});}
+        else {E.repartition[c].clear();}
+    }
+    if (spacing==0){
+        E.repartition[0] = vector<int>({E.species[0].id});
+        E.repartition[(E.m-1)*E.n] = vector<int>({E.species[1].id});
+        E.repartition[E.m*E.n-1] = vector<int>({E.species[2].id});
+    }
+
+    E.selectionType = selection;
+    E.migrationMethod = method;
+    E.solver = solver;
+    E.tileSize = 8;
+    E.rowBoundary = rowBoundary;
+    E.columnBoundary = columnBoundary;
+    E.setNeighbourhood(neighbourhood);
+    return E;
+}
+
+//Candidates of every node after one migration, in the order of their first arrival (a species reaching
+//a node from several sources is counted once)
+vector<vector<int>> candidates(Environment E)
+{
+    Environment migrated = E.migration();
+    vector<vector<int>> firsts(E.m*E.n);
+    for (int c=0; c<E.m*E.n; c++){
+        for (int id : migrated.repartition[c]){
+            if (find(firsts[c].begin(), firsts[c].end(), id) == firsts[c].end()){firsts[c].push_back(id);}
+        }
+    }
+    return firsts;
+}
+
+int main()
+{
+    int failures = 0;
+    vector<pair<string,string>> boundaries = {{"open", "open"}, {"periodic", "reflective"}, {"reflective", "periodic"}};
+
+    for (string neighbourhood : {"vonNeumann", "moore"}){
+        for (auto& boundary : boundaries){
+            for (string selection : {"determinist", "proportional", "softmax"}){
+                string name = neighbourhood+" "+boundary.first+"/"+boundary.second+" "+selection;
+
+                //Candidates of one migration (the sparse lattices have nodes reached across the boundaries only)
+                for (int spacing : {0, 3, 40}){
+                    vector<vector<int>> expected = candidates(filled(neighbourhood, boundary.first, boundary.second, selection, "stencil", "iterative", spacing));
+                    for (string method : {"distance", "auto"}){
+                        if (candidates(filled(neighbourhood, boundary.first, boundary.second, selection, method, "iterative", spacing)) != expected){
+                            cout << "FAIL " << name << " : candidates of the migration (" << method << ", spacing " << spacing << ")\n";
+                            failures++;
+                        }
+                    }
+                }
+
+                //Simulations of every solver
+                Simulation expected(filled(neighbourhood, boundary.first, boundary.second, selection, "stencil", "iterative"), 40);
+                for (string method : {"stencil", "distance", "auto"}){
+                    for (string solver : {"iterative", "auto", "tiled"}){
+                        Simulation run(filled(neighbourhood, boundary.first, boundary.second, selection, method, solver), 40);
+                        if ((run.environment.repartition != expected.environment.repartition)
+                            or (run.environment.numberOfChanges != expected.environment.numberOfChanges)
+                            or (run.colonisationTime != expected.colonisationTime)
+                            or (run.timeBeforeStationarity != expected.timeBeforeStationarity)){
+                            cout << "FAIL " << name << " : Simulation (" << method << ", " << solver << " solver)\n";
+                            failures++;
+                        }
+                    }
+                }
+                cout << "checked " << name << "\n";
+            }
+        }
+    }
+
+    cout << ((failures==0) ? "migration : ok" : "migration : FAILED") << "\n";
+    return (failures==0) ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <filesystem>
+#include "lattice.hpp"
+#include "Simulation.hpp"
+#include "OutOfCore.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Regression check of the out-of-core run (OutOfCore.hpp).
+//
+// Three species from opposite corners and the centre of a random environment. For
+// determinist and stochastic migration, every selection type and tiles smaller than,
+// not dividing and larger than the lattice, the final occupants and numbers of changes
+// (writeBack), the colonisation times, the time before stationarity and the final counts
+// must be the ones of the iterative Simulation of the same environment.
+//
+//======================================================================
+
+//Environment of the check
+Environment region(string migration, string selection)
+{
+    Environment E = lattice("outofcore", 37, 29, {1, 2, 1});
+    E.repartition[(E.m/2)*E.n+E.n/2] = vector<int>({E.species[2].id});
+
+    E.migrationType = migration;
+    E.selectionType = selection;
+    E.dispersalProbability = 0.6;
+    E.solver = "iterative";
+    return E;
+}
+
+int main()
+{
+    int failures = 0;
+    int nIter = 60;
+    string directory = (filesystem::temp_directory_path() / "check-outofcore").string();
+
+    for (string migration : {"determinist", "stochastic"}){
+        for (string selection : {"determinist", "proportional", "softmax"}){
+            string name = migration+"/"+selection;
+            Environment E = region(migration, selection);
+            Simulation expected(E, nIter);
+
+            for (int side : {5, 8, 16, 64}){
+                OutOfCore run(E, directory, side);
+                run.run(nIter);
+                Environment final(E);
+                run.writeBack(final);
+
+                bool same = (final.repartition == expected.environment.repartition)
+                            and (final.numberOfChanges == expected.environment.numberOfChanges)
+                            and (run.timeBeforeStationarity == expected.timeBeforeStationarity)
+                            and (run.counts == expected.environment.countPopulations());
+                for (int c=0; same and (c<E.m*E.n); c++){
+                    same = (run.colonisationAt(c/E.n, c%E.n) == expected.colonisationTime[c]);
+                }
+                if (!same){
+                    cout << "FAIL " << name << " : tiles of " << side << "\n";
+                    failures++;
+                }
+            }
+            cout << "checked " << name << "\n";
+        }
+    }
+    filesystem::remove_all(directory);
+
+    cout << ((failures==0) ? "outofcore : ok" : "outofcore : FAILED") << "\n";
+    return (failures==0) ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include "lattice.hpp"
+#include "Simulation.hpp"
+
+using namespace std;
+
+//======================================================================
+//                          Description
+//======================================================================
+//
+// Regression check of the Simulations run as several cooperating processes
+// (Environment::processes, see DomainDecomposition.hpp).
+//
+// For determinist and stochastic rules, with open, periodic and reflective boundaries,
+// the Simulation of 2, 3 and 5 processes must give the occupants, the numbers of
+// changes, the colonisation times and the population series of the single process.
+//
+//======================================================================
+
+//Environment of the check : three species from opposite corners and the centre of a random environment
+Environment decomposed(string migration, string selection, string rowBoundary, string columnBoundary, int processes)
+{
+    Environment E = lattice("processes", 37, 29, {1, 2, 1});
+    E.repartition[(E.m/2)*E.n+E.n/2] = vector<int>({E.species[2].id});
+
+    E.migrationType = migration;
+    E.selectionType = selection;
+    E.dispersalProbability = 0.6;
+    E.rowBoundary = rowBoundary;
+    E.columnBoundary = columnBoundary;
+    E.processes = processes;
+    E.solver = (processes > 1) ? "auto" : "iterative";
+    return E;
+}
+
+int main()
+{
+    int failures = 0;
+    vector<pair<string,string>> rules = {{"determinist", "determinist"}, {"stochastic", "proportional"}, {"determinist", "softmax"}};
+    vector<pair<string,string>> boundaries = {{"open", "open"}, {"periodic", "reflective"}};
+
+    for (auto& rule : rules){
+        for (auto& boundary : boundaries){
+            string name = rule.first+"/"+rule.second+" "+boundary.first+"/"+boundary.second;
+            Simulation expected(decomposed(rule.first, rule.second, boundary.first, boundary.second, 1), 60);
+            for (int processes : {2, 3, 5}){
+                Environment E = decomposed(rule.first, rule.second, boundary.first, boundary.second, processes);
+                if (!E.usesDomainDecomposition()){
+                    cout << "FAIL " << name << " : not run as " << processes << " processes\n";
+                    failures++;
+                    continue;
+                }
+                Simulation run(E, 60);
+                if ((run.environment.repartition != expected.environment.repartition)
+                    or (run.environment.numberOfChanges != expected.environment.numberOfChanges)
+                    or (run.colonisationTime != expected.colonisationTime)
+                    or (run.countVector.size() != expected.countVector.size())
+                    or (run.timeBeforeStationarity != expected.timeBeforeStationarity)){
+                    cout << "FAIL " << name << " : " << processes << " processes\n";
+                    failures++;
+                }
+                else {
+                    for (int t=0; t<int(run.countVector.size()); t++){
+                        if (!(run.countVector[t] == expected.countVector[t])){
+                            cout << "FAIL " << name << " : " << processes << " processes, populations at " << t << "\n";
+                            failures++;
+                            break;
+                        }
+                    }
+                }
+            }
+            cout << "checked " << name << "\n";
+        }
+    }
+
+    cout << ((failures==0) ? "processes : ok" : "processes : FAILED") << "\n";
+    return (failures==0) ? 0 : 1;
+}